@@ -0,0 +1,846 @@
+/**
+ * @file benchmark.c
+ * @brief timing helpers and benchmarks, enabled with RUN_BENCHMARKS
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * Results are printed as markdown tables so they can be pasted straight into the doxygen pages.
+ */
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+
+#include "benchmark.h"
+#include "cmprss_pipeline.h"
+#include "cmprss_dispatch.h"
+#include "cmprss_test_data.h"
+#include "cmprss_predict.h"
+#include "cmprss_prof.h"
+#include "cmprss_formats.h"
+
+static buffer_element_t bench_samples[BENCH_NUM_SAMPLES];
+static uint64_t bench_latency_ns[BENCH_NUM_SAMPLES];
+static cmprss_pipeline_t bench_pipeline;
+
+/**
+ * @brief monotonic time in nanoseconds, clock() does not have the resolution for per sample timing
+ *
+ * @return uint64_t
+ */
+uint64_t benchmark_now_ns(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return ((uint64_t)now.tv_sec * 1000000000ull) + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * @brief the self tests' xorshift32, repeatable between runs and platforms unlike rand()
+ *
+ * @param state must not be 0
+ * @return uint32_t
+ */
+uint32_t benchmark_rand(uint32_t *state)
+{
+  return cmprss_test_rand(state);
+}
+
+/**
+ * @brief fills the array with a slowly wandering 7-bit signal that holds each value for a few samples,
+ * roughly what our acquisition channels look like
+ *
+ * @param data_ptr
+ * @param data_size
+ * @param seed
+ */
+void benchmark_fill_samples(buffer_element_t *data_ptr, array_size_t data_size, uint32_t seed)
+{
+  uint32_t state = seed | 1;
+  int16_t value = 0x40;
+  array_size_t hold = 0;
+
+  for (array_size_t k = 0; k < data_size; k++)
+  {
+    if (hold == 0)
+    {
+      value += (int16_t)(benchmark_rand(&state) % 9) - 4;
+      if (value < 0)
+        value = 0;
+      if (value > MAX_NON_TOKEN_DATA)
+        value = MAX_NON_TOKEN_DATA;
+      hold = 1 + (benchmark_rand(&state) % 6);
+    }
+    data_ptr[k] = (buffer_element_t)value;
+    hold--;
+  }
+}
+
+static int compare_u64(const void *a, const void *b)
+{
+  uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+/**
+ * @brief sorts the latencies in place and prints one table row of percentiles
+ *
+ * @param label
+ * @param latency_ns
+ * @param count
+ */
+void benchmark_print_latency(const char *label, uint64_t *latency_ns, array_size_t count)
+{
+  if (count == 0)
+    return;
+
+  qsort(latency_ns, count, sizeof(uint64_t), compare_u64);
+  printf("| %-24s | %8llu | %8llu | %8llu | %8llu | %8llu |\n", label,
+         (unsigned long long)latency_ns[count / 2],
+         (unsigned long long)latency_ns[(count * 99) / 100],
+         (unsigned long long)latency_ns[(count * 999) / 1000],
+         (unsigned long long)latency_ns[(count * 9999) / 10000],
+         (unsigned long long)latency_ns[count - 1]);
+}
+
+/**
+ * @brief busy waits until the next sample is due, yields so a single core machine still runs the consumer
+ *
+ * @param deadline_ns
+ */
+static void wait_for_sample(uint64_t deadline_ns)
+{
+  while (benchmark_now_ns() < deadline_ns)
+    sched_yield();
+}
+
+typedef struct
+{
+  uint64_t blocks;
+  uint64_t raw_bytes;
+  uint64_t cmprss_bytes;
+  uint64_t bad_blocks;
+} pipeline_totals_t;
+
+/**
+ * @brief pops every ready block off of the pipeline, tallies it and checks its round trip
+ *
+ * @param pipeline
+ * @param totals
+ */
+static void drain_pipeline(cmprss_pipeline_t *pipeline, pipeline_totals_t *totals)
+{
+  cmprss_block_t out_block;
+  buffer_element_t decmprss[MAX_INPUT_SIZE];
+
+  while (cmprss_pipeline_pop_block(pipeline, &out_block))
+  {
+    totals->blocks++;
+    totals->raw_bytes += out_block.raw_size;
+    totals->cmprss_bytes += out_block.cmprss_size;
+
+    // the sequence number only locates the raw samples while nothing has been dropped
+    if ((out_block.cmprss_size < out_block.raw_size) && (atomic_load(&pipeline->dropped_samples) == 0))
+    {
+      memset(decmprss, 0, sizeof(decmprss));
+      (void)byte_decompress(decmprss, MAX_INPUT_SIZE, out_block.data, out_block.cmprss_size);
+      if (!ArraysAreEqual(decmprss, &bench_samples[out_block.seq * PIPELINE_BLOCK_SIZE], out_block.raw_size))
+        totals->bad_blocks++;
+    }
+  }
+}
+
+/**
+ * @brief producer side latency of the acquisition loop, compressing inline vs handing off to cmprss_pipeline
+ *
+ * Each sample is timed from the moment it is "acquired" to the moment the sampling thread is free again.
+ * Inline, every PIPELINE_BLOCK_SIZE-th sample pays for byte_compress. With the pipeline only the ring push is paid.
+ */
+void run_pipeline_benchmark(void)
+{
+  buffer_element_t block[PIPELINE_BLOCK_SIZE + PIPELINE_BLOCK_PAD];
+  array_size_t fill = 0;
+  uint64_t start_ns = 0, t0 = 0, inline_bytes = 0;
+  int cmprss_size = 0;
+  pipeline_totals_t totals = {0};
+
+  benchmark_fill_samples(bench_samples, BENCH_NUM_SAMPLES, 0x5EED);
+
+  printf("\n### Producer latency, %u samples paced at %u ns\n", BENCH_NUM_SAMPLES, BENCH_SAMPLE_PERIOD_NS);
+  printf("| %-24s | %8s | %8s | %8s | %8s | %8s |\n", "mode (ns)", "p50", "p99", "p99.9", "p99.99", "max");
+  printf("|--------------------------|----------|----------|----------|----------|----------|\n");
+
+  // inline, the sampling thread compresses each block itself
+  start_ns = benchmark_now_ns();
+  for (array_size_t k = 0; k < BENCH_NUM_SAMPLES; k++)
+  {
+    wait_for_sample(start_ns + (k * BENCH_SAMPLE_PERIOD_NS));
+
+    t0 = benchmark_now_ns();
+    block[fill++] = bench_samples[k];
+    if (fill == PIPELINE_BLOCK_SIZE)
+    {
+      memset(&block[PIPELINE_BLOCK_SIZE], ERASED_BYTE, PIPELINE_BLOCK_PAD);
+      cmprss_size = byte_compress(block, PIPELINE_BLOCK_SIZE);
+      inline_bytes += ((cmprss_size <= 0) || (cmprss_size >= PIPELINE_BLOCK_SIZE)) ? PIPELINE_BLOCK_SIZE : (uint64_t)cmprss_size;
+      fill = 0;
+    }
+    bench_latency_ns[k] = benchmark_now_ns() - t0;
+  }
+  benchmark_print_latency("inline byte_compress", bench_latency_ns, BENCH_NUM_SAMPLES);
+
+  // pipeline, the sampling thread only pushes. Draining the output ring is not part of the sampled latency
+  if (cmprss_pipeline_start(&bench_pipeline) != 0)
+  {
+    printf("could not start the pipeline consumer thread\n");
+    return;
+  }
+  start_ns = benchmark_now_ns();
+  for (array_size_t k = 0; k < BENCH_NUM_SAMPLES; k++)
+  {
+    wait_for_sample(start_ns + (k * BENCH_SAMPLE_PERIOD_NS));
+
+    t0 = benchmark_now_ns();
+    (void)cmprss_pipeline_push(&bench_pipeline, bench_samples[k]);
+    bench_latency_ns[k] = benchmark_now_ns() - t0;
+
+    drain_pipeline(&bench_pipeline, &totals);
+  }
+  benchmark_print_latency("cmprss_pipeline push", bench_latency_ns, BENCH_NUM_SAMPLES);
+
+  drain_pipeline(&bench_pipeline, &totals);
+  cmprss_pipeline_stop(&bench_pipeline);
+  drain_pipeline(&bench_pipeline, &totals);
+
+  printf("\ninline: %u -> %llu bytes\n", BENCH_NUM_SAMPLES, (unsigned long long)inline_bytes);
+  printf("pipeline: %llu blocks (%llu compressed, %llu stored), %llu -> %llu bytes, %llu samples dropped, %llu bad round trips\n",
+         (unsigned long long)totals.blocks,
+         (unsigned long long)atomic_load(&bench_pipeline.blocks_compressed),
+         (unsigned long long)atomic_load(&bench_pipeline.blocks_stored),
+         (unsigned long long)totals.raw_bytes, (unsigned long long)totals.cmprss_bytes,
+         (unsigned long long)atomic_load(&bench_pipeline.dropped_samples),
+         (unsigned long long)totals.bad_blocks);
+}
+
+#define KERNEL_BENCH_BLOCKS 1024
+#define KERNEL_BENCH_REPEAT 64
+
+static buffer_element_t kernel_bench_cmprss[KERNEL_BENCH_BLOCKS][PIPELINE_BLOCK_SIZE + PIPELINE_BLOCK_PAD];
+static array_size_t kernel_bench_cmprss_size[KERNEL_BENCH_BLOCKS];
+
+/**
+ * @brief throughput of every supported scan/decode kernel set on the acquisition signal
+ *
+ * estimate_size runs over MAX_INPUT_SIZE chunks, decompress over the same 64 byte blocks the pipeline produces.
+ */
+void run_kernel_benchmark(void)
+{
+  const cmprss_kernels_t *kernels = NULL;
+  buffer_element_t decmprss[MAX_INPUT_SIZE];
+  uint64_t t0 = 0, estimate_ns = 0, decompress_ns = 0, raw_bytes = 0, sink = 0;
+  int cmprss_size = 0;
+
+  benchmark_fill_samples(bench_samples, BENCH_NUM_SAMPLES, 0x5EED);
+  for (array_size_t b = 0; b < KERNEL_BENCH_BLOCKS; b++)
+  {
+    memset(kernel_bench_cmprss[b], ERASED_BYTE, sizeof(kernel_bench_cmprss[b]));
+    memcpy(kernel_bench_cmprss[b], &bench_samples[b * PIPELINE_BLOCK_SIZE], PIPELINE_BLOCK_SIZE);
+    cmprss_size = byte_compress(kernel_bench_cmprss[b], PIPELINE_BLOCK_SIZE);
+    kernel_bench_cmprss_size[b] = ((cmprss_size <= 1) || (cmprss_size >= PIPELINE_BLOCK_SIZE)) ? 0 : (array_size_t)cmprss_size;
+  }
+
+  printf("\n### Scan/decode kernels, bound: %s\n", cmprss_kernels.name);
+  printf("| %-10s | %14s | %16s |\n", "kernel", "estimate MB/s", "decompress MB/s");
+  printf("|------------|----------------|------------------|\n");
+
+  for (uint8_t k = 0; (kernels = cmprss_dispatch_get(k)) != NULL; k++)
+  {
+    if (!kernels->is_supported())
+      continue;
+
+    t0 = benchmark_now_ns();
+    for (array_size_t offset = 0; (offset + MAX_INPUT_SIZE + NIBBLE_MAX) < BENCH_NUM_SAMPLES; offset += MAX_INPUT_SIZE)
+      sink += (uint64_t)kernels->estimate_size(&bench_samples[offset], MAX_INPUT_SIZE);
+    estimate_ns = benchmark_now_ns() - t0;
+
+    raw_bytes = 0;
+    t0 = benchmark_now_ns();
+    for (uint32_t r = 0; r < KERNEL_BENCH_REPEAT; r++)
+    {
+      for (array_size_t b = 0; b < KERNEL_BENCH_BLOCKS; b++)
+      {
+        if (kernel_bench_cmprss_size[b] == 0)
+          continue;
+        sink += (uint64_t)kernels->decompress(decmprss, MAX_INPUT_SIZE, kernel_bench_cmprss[b], kernel_bench_cmprss_size[b]);
+        raw_bytes += PIPELINE_BLOCK_SIZE;
+      }
+    }
+    decompress_ns = benchmark_now_ns() - t0;
+
+    printf("| %-10s | %14.1f | %16.1f |\n", kernels->name,
+           (double)BENCH_NUM_SAMPLES * 1000.0 / (double)(estimate_ns + 1),
+           (double)raw_bytes * 1000.0 / (double)(decompress_ns + 1));
+  }
+  // keeps the calls from being optimized away
+  if (sink == 0)
+    printf("\n");
+}
+
+#define PREDICT_BENCH_BUFFERS 20000
+#define PREDICT_BENCH_REPEAT 8
+#define PREDICT_BENCH_ROUNDS 5
+#define PREDICT_BENCH_PAD 16
+
+typedef enum
+{
+  CORPUS_RANDOM = 0,
+  CORPUS_SIGNAL,
+  CORPUS_NOISY,
+  CORPUS_TEXT,
+  NUM_CORPUS_KINDS
+} corpus_kind_t;
+
+static const char *const corpus_names[NUM_CORPUS_KINDS] = {"high entropy", "acquisition", "noisy sensor", "text"};
+static buffer_element_t predict_corpus[PREDICT_BENCH_BUFFERS][MAX_INPUT_SIZE + PREDICT_BENCH_PAD];
+static array_size_t predict_corpus_size[PREDICT_BENCH_BUFFERS];
+static uint8_t predict_corpus_kind[PREDICT_BENCH_BUFFERS];
+
+/**
+ * @brief builds the mixed traffic corpus, 40% high entropy like our links see, the rest split between
+ * acquisition blocks, a noisy sensor which hardly ever repeats and 7-bit text
+ *
+ */
+static void build_predict_corpus(void)
+{
+  static const char text[] = "status ok temp 23.5 fan 1200 rpm battery 87 pct link up retries 0 uptime 3d 4h ";
+  uint32_t state = 0xC0FFEE;
+  int16_t value = 0;
+
+  for (uint32_t b = 0; b < PREDICT_BENCH_BUFFERS; b++)
+  {
+    buffer_element_t *data_ptr = predict_corpus[b];
+    // byte_compress keeps its write index in a uint8_t, stay below 256
+    array_size_t size = 64 + (benchmark_rand(&state) % (MAX_INPUT_SIZE - 64));
+    uint32_t pick = benchmark_rand(&state) % 100;
+    corpus_kind_t kind = (pick < 40) ? CORPUS_RANDOM : (pick < 70) ? CORPUS_SIGNAL : (pick < 85) ? CORPUS_NOISY : CORPUS_TEXT;
+    array_size_t offset = benchmark_rand(&state) % (sizeof(text) - 1);
+
+    memset(data_ptr, ERASED_BYTE, MAX_INPUT_SIZE + PREDICT_BENCH_PAD);
+    switch (kind)
+    {
+      case CORPUS_SIGNAL:
+        benchmark_fill_samples(data_ptr, size, benchmark_rand(&state));
+        break;
+      case CORPUS_NOISY:
+        value = (int16_t)(benchmark_rand(&state) & MAX_NON_TOKEN_DATA);
+        for (array_size_t k = 0; k < size; k++)
+        {
+          value += (int16_t)(benchmark_rand(&state) % 5) - 2;
+          value &= MAX_NON_TOKEN_DATA;
+          data_ptr[k] = (buffer_element_t)value;
+        }
+        break;
+      case CORPUS_TEXT:
+        for (array_size_t k = 0; k < size; k++)
+          data_ptr[k] = (buffer_element_t)text[(offset + k) % (sizeof(text) - 1)];
+        break;
+      default:
+        for (array_size_t k = 0; k < size; k++)
+          data_ptr[k] = (buffer_element_t)(benchmark_rand(&state) & MAX_NON_TOKEN_DATA);
+        break;
+    }
+    predict_corpus_size[b] = size;
+    predict_corpus_kind[b] = (uint8_t)kind;
+  }
+}
+
+/**
+ * @brief throughput of the stored/compress decision byte_compress makes before touching the buffer. For a
+ * hopeless buffer that decision is all byte_compress does, and compressible buffers pay the same tokenizing cost
+ * either way, so this is where the predictor wins or loses. The tokenizer itself is left out because it is not
+ * yet memory safe on every buffer of this corpus.
+ *
+ * @return double MB/s
+ */
+static double time_corpus_decision(void)
+{
+  uint64_t t0 = 0, bytes = 0, sink = 0;
+
+  t0 = benchmark_now_ns();
+  for (uint32_t r = 0; r < PREDICT_BENCH_REPEAT; r++)
+  {
+    for (uint32_t b = 0; b < PREDICT_BENCH_BUFFERS; b++)
+    {
+      sink += byte_compress_would_expand(predict_corpus[b], predict_corpus_size[b]);
+      bytes += predict_corpus_size[b];
+    }
+  }
+  t0 = benchmark_now_ns() - t0;
+
+  return (sink != 0) ? ((double)bytes * 1000.0 / (double)(t0 + 1)) : 0.0;
+}
+
+/**
+ * @brief how often cmprss_predict disagrees with the full estimate pass, and what skipping saves
+ *
+ * A false skip is a buffer the predictor called hopeless although estimate_array_size says it would shrink,
+ * that costs ratio. A missed skip is a hopeless buffer the predictor let through, that only costs time.
+ */
+void run_predictor_benchmark(void)
+{
+  uint32_t count[NUM_CORPUS_KINDS] = {0}, skipped[NUM_CORPUS_KINDS] = {0};
+  uint32_t false_skips[NUM_CORPUS_KINDS] = {0}, missed_skips[NUM_CORPUS_KINDS] = {0};
+  uint64_t lost_bytes = 0, ratio_sum = 0, ratio_inside = 0, compressible = 0;
+  cmprss_prediction_t prediction;
+  int estimate = 0;
+  double with_predictor = 0.0, without_predictor = 0.0, rate = 0.0;
+  uint8_t was_enabled = cmprss_predict_enabled;
+
+  build_predict_corpus();
+
+  for (uint32_t b = 0; b < PREDICT_BENCH_BUFFERS; b++)
+  {
+    uint8_t kind = predict_corpus_kind[b];
+    array_size_t size = predict_corpus_size[b];
+
+    prediction = cmprss_predict(predict_corpus[b], size);
+    estimate = estimate_array_size(predict_corpus[b], size);
+    count[kind]++;
+    skipped[kind] += prediction.hopeless;
+    if (prediction.hopeless && ((array_size_t)estimate < size))
+    {
+      false_skips[kind]++;
+      lost_bytes += size - (array_size_t)estimate;
+    }
+    if (!prediction.hopeless && ((array_size_t)estimate >= size))
+      missed_skips[kind]++;
+    if ((array_size_t)estimate < size)
+    {
+      // how good is the ratio estimate itself where it matters
+      uint32_t actual = (uint32_t)((estimate * 1000) / size);
+      compressible++;
+      ratio_sum += (actual > prediction.ratio_permille) ? (actual - prediction.ratio_permille) : (prediction.ratio_permille - actual);
+      ratio_inside += (actual >= prediction.ratio_low_permille) && (actual <= prediction.ratio_high_permille);
+    }
+  }
+
+  printf("\n### Compressibility predictor, %u buffers of 64 to %u bytes\n", PREDICT_BENCH_BUFFERS, MAX_INPUT_SIZE - 1);
+  printf("| %-14s | %7s | %9s | %11s | %12s |\n", "corpus", "buffers", "skipped %", "false skips", "missed skips");
+  printf("|----------------|---------|-----------|-------------|--------------|\n");
+  for (uint8_t kind = 0; kind < NUM_CORPUS_KINDS; kind++)
+  {
+    printf("| %-14s | %7u | %9.1f | %11u | %12u |\n", corpus_names[kind], count[kind],
+           (count[kind] != 0) ? (100.0 * skipped[kind] / count[kind]) : 0.0, false_skips[kind], missed_skips[kind]);
+  }
+  printf("\nfalse skips cost %llu bytes of compression. On compressible buffers the predicted ratio is off by %.1f%% on average, %.1f%% land inside the 99%% bounds\n",
+         (unsigned long long)lost_bytes,
+         (compressible != 0) ? ((double)ratio_sum / (double)compressible / 10.0) : 0.0,
+         (compressible != 0) ? (100.0 * (double)ratio_inside / (double)compressible) : 0.0);
+
+  // alternate the two and keep the best of each, a single pass is at the mercy of whatever else the machine does
+  for (uint8_t round = 0; round < PREDICT_BENCH_ROUNDS; round++)
+  {
+    cmprss_predict_enabled = 0;
+    rate = time_corpus_decision();
+    without_predictor = (rate > without_predictor) ? rate : without_predictor;
+    cmprss_predict_enabled = 1;
+    rate = time_corpus_decision();
+    with_predictor = (rate > with_predictor) ? rate : with_predictor;
+  }
+  cmprss_predict_enabled = was_enabled;
+
+  printf("store or compress decision over the corpus: %.1f MB/s with the full estimate only, %.1f MB/s with the predictor (%.2fx)\n",
+         without_predictor, with_predictor, with_predictor / without_predictor);
+}
+
+#define PROFILE_BENCH_BLOCKS (BENCH_NUM_SAMPLES / PIPELINE_BLOCK_SIZE)
+#define PROFILE_BENCH_REPEAT 8
+
+static buffer_element_t profile_bench_cmprss[PROFILE_BENCH_BLOCKS][PIPELINE_BLOCK_SIZE + PIPELINE_BLOCK_PAD];
+static array_size_t profile_bench_cmprss_size[PROFILE_BENCH_BLOCKS];
+
+/**
+ * @brief per phase counters for byte_compress and byte_decompress on the acquisition signal, in the same 64 byte
+ * blocks the pipeline compresses. Needs a PROFILE_PHASES=1 build, without it the codec has no phase marks.
+ *
+ */
+void run_profile_benchmark(void)
+{
+  buffer_element_t decmprss[MAX_INPUT_SIZE];
+  uint64_t sink = 0;
+  int cmprss_size = 0;
+  char title[96];
+
+  cmprss_prof_init();
+  benchmark_fill_samples(bench_samples, BENCH_NUM_SAMPLES, 0x5EED);
+
+  cmprss_prof_reset();
+  for (uint32_t r = 0; r < PROFILE_BENCH_REPEAT; r++)
+  {
+    for (array_size_t b = 0; b < PROFILE_BENCH_BLOCKS; b++)
+    {
+      memset(profile_bench_cmprss[b], ERASED_BYTE, sizeof(profile_bench_cmprss[b]));
+      memcpy(profile_bench_cmprss[b], &bench_samples[b * PIPELINE_BLOCK_SIZE], PIPELINE_BLOCK_SIZE);
+      cmprss_size = byte_compress(profile_bench_cmprss[b], PIPELINE_BLOCK_SIZE);
+      profile_bench_cmprss_size[b] = ((cmprss_size <= 1) || (cmprss_size >= PIPELINE_BLOCK_SIZE)) ? 0 : (array_size_t)cmprss_size;
+    }
+  }
+  snprintf(title, sizeof(title), "byte_compress, %u x %u blocks of %u bytes", PROFILE_BENCH_REPEAT, PROFILE_BENCH_BLOCKS, PIPELINE_BLOCK_SIZE);
+  cmprss_prof_print(title);
+
+  cmprss_prof_reset();
+  for (uint32_t r = 0; r < PROFILE_BENCH_REPEAT; r++)
+  {
+    for (array_size_t b = 0; b < PROFILE_BENCH_BLOCKS; b++)
+    {
+      if (profile_bench_cmprss_size[b] != 0)
+        sink += (uint64_t)byte_decompress(decmprss, MAX_INPUT_SIZE, profile_bench_cmprss[b], profile_bench_cmprss_size[b]);
+    }
+  }
+  snprintf(title, sizeof(title), "byte_decompress (%s kernels), the compressed blocks above", cmprss_kernels.name);
+  cmprss_prof_print(title);
+
+  // keeps the calls from being optimized away
+  if (sink == 0)
+    printf("\n");
+}
+
+#define FORMAT_BENCH_ROUNDS 3
+#define FORMAT_BENCH_LARGE_BLOCK 4096
+
+typedef enum
+{
+  CHANNEL_ACQUISITION = 0,
+  CHANNEL_NOISY,
+  CHANNEL_SLOW,
+  CHANNEL_IDLE,
+  NUM_CHANNEL_KINDS
+} channel_kind_t;
+
+static const char *const channel_names[NUM_CHANNEL_KINDS] = {"acquisition", "noisy sensor", "slow sensor", "idle line"};
+static const array_size_t format_bench_block_sizes[] = {PIPELINE_BLOCK_SIZE, FORMAT_BENCH_LARGE_BLOCK};
+static buffer_element_t format_bench_cmprss[CMPRSS_FORMAT_MAX_OVERHEAD(BENCH_NUM_SAMPLES) + PIPELINE_BLOCK_SIZE];
+static buffer_element_t format_bench_decmprss[BENCH_NUM_SAMPLES];
+static array_size_t format_bench_sizes[BENCH_NUM_SAMPLES / PIPELINE_BLOCK_SIZE];
+
+/**
+ * @brief fills the array with one of the channel shapes the formats are meant to be picked for. Values use the
+ * full byte range since the formats do not reserve a token bit in the data
+ *
+ * @param kind
+ * @param data_ptr
+ * @param data_size
+ * @param seed
+ */
+static void fill_format_channel(channel_kind_t kind, buffer_element_t *data_ptr, array_size_t data_size, uint32_t seed)
+{
+  uint32_t state = seed | 1;
+  int16_t value = 0x80;
+  array_size_t hold = 0;
+
+  if (kind == CHANNEL_ACQUISITION)
+  {
+    benchmark_fill_samples(data_ptr, data_size, seed);
+    return;
+  }
+
+  for (array_size_t k = 0; k < data_size; k++)
+  {
+    if (hold == 0)
+    {
+      switch (kind)
+      {
+        case CHANNEL_NOISY:
+          // hardly ever repeats, an occasional short run
+          value += (int16_t)(benchmark_rand(&state) % 7) - 3;
+          hold = ((benchmark_rand(&state) % 8) == 0) ? 3 : 1;
+          break;
+        case CHANNEL_SLOW:
+          // slow changes, runs of tens of samples
+          value += (int16_t)(benchmark_rand(&state) % 3) - 1;
+          hold = 8 + (benchmark_rand(&state) % 120);
+          break;
+        default:
+          // parked at a level for thousands of samples, short bursts of activity in between
+          if ((benchmark_rand(&state) % 4) == 0)
+          {
+            value = (int16_t)(benchmark_rand(&state) & 0xFF);
+            hold = 1000 + (benchmark_rand(&state) % 20000);
+          }
+          else
+          {
+            value = (int16_t)(benchmark_rand(&state) & 0xFF);
+            hold = 1 + (benchmark_rand(&state) % 4);
+          }
+          break;
+      }
+      value &= 0xFF;
+    }
+    data_ptr[k] = (buffer_element_t)value;
+    hold--;
+  }
+}
+
+/**
+ * @brief ratio and speed of every token format per channel shape and block size, to pick a format per channel.
+ * Every block is decompressed and compared once before it is timed
+ *
+ */
+void run_format_benchmark(void)
+{
+  const cmprss_format_t *format = NULL;
+  array_size_t blocks = 0, cmprss_total = 0, offset = 0, size = 0;
+  uint64_t t0 = 0, compress_ns = 0, decompress_ns = 0, elapsed = 0;
+  uint8_t round_trip = 1;
+
+  printf("\n### Token formats, %u samples per channel\n", BENCH_NUM_SAMPLES);
+  printf("| %-12s | %5s | %-8s | %8s | %12s | %15s |\n", "channel", "block", "format", "ratio %", "compress MB/s", "decompress MB/s");
+  printf("|--------------|-------|----------|----------|--------------|-----------------|\n");
+
+  for (uint8_t kind = 0; kind < NUM_CHANNEL_KINDS; kind++)
+  {
+    fill_format_channel((channel_kind_t)kind, bench_samples, BENCH_NUM_SAMPLES, 0x5EED + kind);
+
+    for (uint8_t s = 0; s < (sizeof(format_bench_block_sizes) / sizeof(format_bench_block_sizes[0])); s++)
+    {
+      array_size_t block_size = format_bench_block_sizes[s];
+      blocks = BENCH_NUM_SAMPLES / block_size;
+
+      for (uint8_t id = 0; id < NUM_CMPRSS_FORMATS; id++)
+      {
+        if ((format = cmprss_format_get((cmprss_format_id_t)id)) == NULL)
+          continue;
+
+        compress_ns = (uint64_t)-1;
+        decompress_ns = (uint64_t)-1;
+        for (uint8_t round = 0; round < FORMAT_BENCH_ROUNDS; round++)
+        {
+          // blocks are packed back to back, each one sized by its own bound
+          cmprss_total = 0;
+          t0 = benchmark_now_ns();
+          for (array_size_t b = 0; b < blocks; b++)
+          {
+            size = format->compress(&format_bench_cmprss[cmprss_total], cmprss_format_bound(format->id, block_size),
+                                    &bench_samples[b * block_size], block_size, NULL);
+            format_bench_sizes[b] = size;
+            cmprss_total += size;
+          }
+          elapsed = benchmark_now_ns() - t0;
+          compress_ns = (elapsed < compress_ns) ? elapsed : compress_ns;
+
+          offset = 0;
+          t0 = benchmark_now_ns();
+          for (array_size_t b = 0; b < blocks; b++)
+          {
+            format->decompress(&format_bench_decmprss[b * block_size], block_size, &format_bench_cmprss[offset], format_bench_sizes[b], NULL);
+            offset += format_bench_sizes[b];
+          }
+          elapsed = benchmark_now_ns() - t0;
+          decompress_ns = (elapsed < decompress_ns) ? elapsed : decompress_ns;
+        }
+
+        if (memcmp(bench_samples, format_bench_decmprss, blocks * block_size) != 0)
+        {
+          printf("format %s does not round trip on the %s channel\n", format->name, channel_names[kind]);
+          round_trip = 0;
+        }
+
+        printf("| %-12s | %5u | %-8s | %8.1f | %12.1f | %15.1f |\n", channel_names[kind], (unsigned)block_size, format->name,
+               100.0 * (double)cmprss_total / (double)(blocks * block_size),
+               (double)(blocks * block_size) * 1000.0 / (double)(compress_ns + 1),
+               (double)(blocks * block_size) * 1000.0 / (double)(decompress_ns + 1));
+      }
+    }
+  }
+
+  if (!round_trip)
+    printf("\nformat round trip FAILED\n");
+}
+
+#define DICT_BENCH_TRAIN 2000
+#define DICT_BENCH_MESSAGES 20000
+#define DICT_BENCH_MIN_SIZE 20
+#define DICT_BENCH_MAX_SIZE 100
+#define DICT_BENCH_ROUNDS 5
+
+typedef struct
+{
+  const char *label;
+  cmprss_format_id_t format;
+  array_size_t dict_size; // 0 runs without a dictionary
+} dict_bench_config_t;
+
+static const dict_bench_config_t dict_bench_configs[] = {
+  {"run130", CMPRSS_FORMAT_RUN130, 0},
+  {"dict66, no dictionary", CMPRSS_FORMAT_DICT66, 0},
+  {"dict66, 256 B", CMPRSS_FORMAT_DICT66, 256},
+  {"dict66, 1 KiB", CMPRSS_FORMAT_DICT66, 1024},
+  {"dict66, 4 KiB", CMPRSS_FORMAT_DICT66, 4096},
+};
+
+static buffer_element_t dict_bench_train[DICT_BENCH_TRAIN * DICT_BENCH_MAX_SIZE];
+static array_size_t dict_bench_train_sizes[DICT_BENCH_TRAIN];
+static buffer_element_t dict_bench_msgs[DICT_BENCH_MESSAGES][DICT_BENCH_MAX_SIZE];
+static array_size_t dict_bench_msg_sizes[DICT_BENCH_MESSAGES];
+static buffer_element_t dict_bench_cmprss[DICT_BENCH_MESSAGES][CMPRSS_FORMAT_MAX_OVERHEAD(DICT_BENCH_MAX_SIZE)];
+static array_size_t dict_bench_cmprss_sizes[DICT_BENCH_MESSAGES];
+static buffer_element_t dict_bench_buffer[DICT_MAX_SIZE];
+static cmprss_dict_t dict_bench_dict;
+
+/**
+ * @brief writes one message of the kind our devices send, DICT_BENCH_MIN_SIZE to DICT_BENCH_MAX_SIZE bytes: a
+ * text status line, a binary sample frame or a json event. Each kind repeats its preamble and field names,
+ * the values change
+ *
+ * @param data_ptr room for DICT_BENCH_MAX_SIZE bytes
+ * @param state benchmark_rand state
+ * @return array_size_t message size
+ */
+static array_size_t fill_message(buffer_element_t *data_ptr, uint32_t *state)
+{
+  static const char *const events[] = {"alarm", "door", "restart", "low_battery", "calibrated"};
+  static const buffer_element_t frame_preamble[] = {0xAA, 0x55, 0x01, 0x4E, 0x42, 0x30, 0x07};
+  char text[DICT_BENCH_MAX_SIZE + 64];
+  uint32_t pick = benchmark_rand(state) % 3;
+  int len = 0;
+  array_size_t size = 0, samples = 0;
+
+  if (pick == 0)
+  {
+    len = snprintf(text, sizeof(text), "$NB07,STATUS,temp=%d.%d,fan=%u,bat=%u,link=%s", 15 + (int)(benchmark_rand(state) % 20),
+                   (int)(benchmark_rand(state) % 10), 1000 + (benchmark_rand(state) % 800), 40 + (benchmark_rand(state) % 60),
+                   ((benchmark_rand(state) % 8) != 0) ? "up" : "down");
+    if ((benchmark_rand(state) % 2) == 0)
+      len += snprintf(&text[len], sizeof(text) - (size_t)len, ",retries=%u", benchmark_rand(state) % 5);
+    len += snprintf(&text[len], sizeof(text) - (size_t)len, "*%02X", benchmark_rand(state) & 0xFF);
+  }
+  else if (pick == 1)
+  {
+    memcpy(data_ptr, frame_preamble, sizeof(frame_preamble));
+    size = sizeof(frame_preamble);
+    data_ptr[size++] = (buffer_element_t)(benchmark_rand(state) & 0xFF); // sequence number
+    samples = 10 + (benchmark_rand(state) % (DICT_BENCH_MAX_SIZE - sizeof(frame_preamble) - 1 - 2 - 10 + 1));
+    benchmark_fill_samples(&data_ptr[size], samples, benchmark_rand(state));
+    size += samples;
+    data_ptr[size++] = (buffer_element_t)(benchmark_rand(state) & 0xFF); // crc
+    data_ptr[size++] = (buffer_element_t)(benchmark_rand(state) & 0xFF);
+    return size;
+  }
+  else
+  {
+    len = snprintf(text, sizeof(text), "{\"dev\":\"pump-%02u\",\"evt\":\"%s\",\"code\":%u,\"ts\":%u}", benchmark_rand(state) % 16,
+                   events[benchmark_rand(state) % (sizeof(events) / sizeof(events[0]))], benchmark_rand(state) % 100,
+                   1760000000u + (benchmark_rand(state) % 1000000));
+  }
+
+  size = ((array_size_t)len < DICT_BENCH_MAX_SIZE) ? (array_size_t)len : DICT_BENCH_MAX_SIZE;
+  if (size < DICT_BENCH_MIN_SIZE)
+    size = DICT_BENCH_MIN_SIZE;
+  memcpy(data_ptr, text, size);
+  return size;
+}
+
+/**
+ * @brief ratio and speed on short messages, with and without a dictionary trained on a separate set of messages.
+ * Messages which do not shrink count at their raw size, they would go out stored
+ *
+ */
+void run_dict_benchmark(void)
+{
+  const dict_bench_config_t *config = NULL;
+  const cmprss_dict_t *dict = NULL;
+  buffer_element_t decmprss[DICT_BENCH_MAX_SIZE];
+  uint32_t state = 0xD1C7;
+  array_size_t train_bytes = 0, dict_size = 0, size = 0;
+  uint64_t raw_total = 0, cmprss_total = 0, raw_small = 0, cmprss_small = 0, stored = 0;
+  uint64_t t0 = 0, elapsed = 0, compress_ns = 0, decompress_ns = 0, train_ns = 0;
+  uint8_t round_trip = 1;
+
+  for (uint32_t m = 0; m < DICT_BENCH_TRAIN; m++)
+  {
+    dict_bench_train_sizes[m] = fill_message(&dict_bench_train[train_bytes], &state);
+    train_bytes += dict_bench_train_sizes[m];
+  }
+  // the messages compressed below are not the ones the dictionary was trained on
+  for (uint32_t m = 0; m < DICT_BENCH_MESSAGES; m++)
+  {
+    dict_bench_msg_sizes[m] = fill_message(dict_bench_msgs[m], &state);
+    raw_total += dict_bench_msg_sizes[m];
+  }
+
+  printf("\n### Short messages, %u messages of %u to %u bytes, dictionaries trained on %u others\n", DICT_BENCH_MESSAGES,
+         DICT_BENCH_MIN_SIZE, DICT_BENCH_MAX_SIZE, DICT_BENCH_TRAIN);
+  printf("| %-22s | %8s | %12s | %8s | %12s | %15s | %8s |\n", "format", "ratio %", "<= 50 bytes %", "stored %", "compress MB/s",
+         "decompress MB/s", "train ms");
+  printf("|------------------------|----------|---------------|----------|--------------|-----------------|----------|\n");
+
+  for (uint8_t c = 0; c < (sizeof(dict_bench_configs) / sizeof(dict_bench_configs[0])); c++)
+  {
+    config = &dict_bench_configs[c];
+    dict = NULL;
+    train_ns = 0;
+    if (config->dict_size != 0)
+    {
+      t0 = benchmark_now_ns();
+      dict_size = cmprss_dict_train(dict_bench_buffer, config->dict_size, dict_bench_train, dict_bench_train_sizes, DICT_BENCH_TRAIN);
+      cmprss_dict_load(&dict_bench_dict, dict_bench_buffer, dict_size);
+      train_ns = benchmark_now_ns() - t0;
+      dict = &dict_bench_dict;
+    }
+
+    compress_ns = (uint64_t)-1;
+    decompress_ns = (uint64_t)-1;
+    for (uint8_t round = 0; round < DICT_BENCH_ROUNDS; round++)
+    {
+      t0 = benchmark_now_ns();
+      for (uint32_t m = 0; m < DICT_BENCH_MESSAGES; m++)
+      {
+        dict_bench_cmprss_sizes[m] = cmprss_format_compress_dict(config->format, dict, dict_bench_cmprss[m], sizeof(dict_bench_cmprss[m]),
+                                                                 dict_bench_msgs[m], dict_bench_msg_sizes[m]);
+      }
+      elapsed = benchmark_now_ns() - t0;
+      compress_ns = (elapsed < compress_ns) ? elapsed : compress_ns;
+
+      t0 = benchmark_now_ns();
+      for (uint32_t m = 0; m < DICT_BENCH_MESSAGES; m++)
+      {
+        size = cmprss_format_decompress_dict(config->format, dict, decmprss, sizeof(decmprss), dict_bench_cmprss[m], dict_bench_cmprss_sizes[m]);
+        round_trip &= (size == dict_bench_msg_sizes[m]) && (memcmp(decmprss, dict_bench_msgs[m], size) == 0);
+      }
+      elapsed = benchmark_now_ns() - t0;
+      decompress_ns = (elapsed < decompress_ns) ? elapsed : decompress_ns;
+    }
+
+    cmprss_total = 0;
+    raw_small = 0;
+    cmprss_small = 0;
+    stored = 0;
+    for (uint32_t m = 0; m < DICT_BENCH_MESSAGES; m++)
+    {
+      size = dict_bench_cmprss_sizes[m];
+      if (size >= dict_bench_msg_sizes[m])
+      {
+        size = dict_bench_msg_sizes[m];
+        stored++;
+      }
+      cmprss_total += size;
+      if (dict_bench_msg_sizes[m] <= 50)
+      {
+        raw_small += dict_bench_msg_sizes[m];
+        cmprss_small += size;
+      }
+    }
+
+    printf("| %-22s | %8.1f | %13.1f | %8.1f | %12.1f | %15.1f | %8.2f |\n", config->label,
+           100.0 * (double)cmprss_total / (double)raw_total,
+           (raw_small != 0) ? (100.0 * (double)cmprss_small / (double)raw_small) : 0.0,
+           100.0 * (double)stored / DICT_BENCH_MESSAGES,
+           (double)raw_total * 1000.0 / (double)(compress_ns + 1),
+           (double)raw_total * 1000.0 / (double)(decompress_ns + 1),
+           (double)train_ns / 1000000.0);
+  }
+
+  if (!round_trip)
+    printf("\nshort message round trip FAILED\n");
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+#include <stdint.h>
+
+#include "compression_test.h"
+
+#define BENCH_NUM_SAMPLES (1u << 20)
+// acquisition rate the producer is paced to, 1 sample/us
+#define BENCH_SAMPLE_PERIOD_NS 1000
+
+uint64_t benchmark_now_ns(void);
+uint32_t benchmark_rand(uint32_t *state);
+void benchmark_fill_samples(buffer_element_t *data_ptr, array_size_t data_size, uint32_t seed);
+void benchmark_print_latency(const char *label, uint64_t *latency_ns, array_size_t count);
+
+void run_pipeline_benchmark(void);
+void run_kernel_benchmark(void);
+void run_predictor_benchmark(void);
+void run_profile_benchmark(void);
+void run_format_benchmark(void);
+void run_dict_benchmark(void);
+
+#endif //BENCHMARK_H
@@ -0,0 +1,225 @@
+/**
+ * @file cmprss_dict.c
+ * @brief shared priming dictionary for short messages, loading, lookup and training
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * A message of a few dozen bytes has no history of its own to compress against, so every one of them starts
+ * cold. The encoder and decoder can instead both load the same dictionary once, a few hundred to a few thousand
+ * bytes of the preambles and fields our messages share. The dictionary formats in cmprss_formats.c then replace
+ * whole stretches of a message with a 3 byte reference into it. cmprss_dict_train builds such a dictionary from
+ * sample messages, dict_train.c wraps it for the command line.
+ */
+#include <string.h>
+
+#include "cmprss_dict.h"
+
+#define FNV_OFFSET 2166136261u
+#define FNV_PRIME 16777619u
+
+/**
+ * @brief hash of the DICT_HASH_BYTES bytes at data_ptr
+ *
+ * @param data_ptr
+ * @return uint32_t
+ */
+static inline uint32_t dict_hash(const buffer_element_t *data_ptr)
+{
+  uint32_t word = 0;
+
+  memcpy(&word, data_ptr, DICT_HASH_BYTES);
+  return (word * 2654435761u) >> (32 - DICT_HASH_BITS);
+}
+
+/**
+ * @brief copies the dictionary in and indexes every position for cmprss_dict_find
+ *
+ * @param dict
+ * @param data_ptr
+ * @param data_size at most DICT_MAX_SIZE, 0 loads an empty dictionary
+ * @return uint8_t 0 if data_size is too large
+ */
+uint8_t cmprss_dict_load(cmprss_dict_t *dict, const buffer_element_t *data_ptr, array_size_t data_size)
+{
+  uint32_t id = FNV_OFFSET, h = 0;
+
+  if (data_size > DICT_MAX_SIZE)
+    return 0;
+
+  memcpy(dict->data, data_ptr, data_size);
+  dict->size = data_size;
+  memset(dict->head, 0, sizeof(dict->head));
+
+  for (array_size_t p = 0; p < data_size; p++)
+    id = (id ^ data_ptr[p]) * FNV_PRIME;
+  dict->id = id;
+
+  // oldest first, so head ends up on the newest position of every chain
+  for (array_size_t p = 0; (p + DICT_HASH_BYTES) <= data_size; p++)
+  {
+    h = dict_hash(&dict->data[p]);
+    dict->chain[p] = dict->head[h];
+    dict->head[h] = (uint16_t)(p + 1);
+  }
+
+  return 1;
+}
+
+/**
+ * @brief longest match for data_ptr in the dictionary
+ *
+ * @param dict
+ * @param data_ptr
+ * @param data_size bytes available at data_ptr
+ * @param max_len
+ * @param offset set to the dictionary position of the match
+ * @return array_size_t match length, 0 if there is none of at least DICT_HASH_BYTES bytes
+ */
+array_size_t cmprss_dict_find(const cmprss_dict_t *dict, const buffer_element_t *data_ptr, array_size_t data_size, array_size_t max_len,
+                              array_size_t *offset)
+{
+  array_size_t best = 0, len = 0, limit = 0, p = 0;
+  uint16_t candidate = 0;
+
+  if (data_size < DICT_HASH_BYTES)
+    return 0;
+  if (max_len > data_size)
+    max_len = data_size;
+
+  candidate = dict->head[dict_hash(data_ptr)];
+  for (uint8_t tries = 0; (candidate != 0) && (tries < DICT_MAX_CHAIN); tries++)
+  {
+    p = (array_size_t)candidate - 1;
+    limit = dict->size - p;
+    if (limit > max_len)
+      limit = max_len;
+
+    len = 0;
+    while ((len < limit) && (dict->data[p + len] == data_ptr[len]))
+      len++;
+    if (len > best)
+    {
+      best = len;
+      *offset = p;
+      if (best == max_len)
+        break;
+    }
+    candidate = dict->chain[p];
+  }
+
+  return (best >= DICT_HASH_BYTES) ? best : 0;
+}
+
+/**
+ * @brief hash of the DICT_TRAIN_KMER bytes at data_ptr, for the training frequency table
+ *
+ * @param data_ptr
+ * @return uint32_t
+ */
+static inline uint32_t kmer_hash(const buffer_element_t *data_ptr)
+{
+  uint32_t h = FNV_OFFSET;
+
+  for (uint8_t k = 0; k < DICT_TRAIN_KMER; k++)
+    h = (h ^ data_ptr[k]) * FNV_PRIME;
+
+  return h >> (32 - DICT_TRAIN_TABLE_BITS);
+}
+
+/**
+ * @brief builds a dictionary from sample messages, greedily picking the segments which cover the most
+ * frequent k-mers (the cover algorithm zstd trains with)
+ *
+ * Every k-mer is scored by the number of samples it appears in. Each round takes the window of
+ * DICT_TRAIN_SEGMENT bytes, from any sample, with the highest total score. Its k-mers are then zeroed, so the
+ * next round picks something the dictionary does not cover yet. Training stops when the dictionary is full or
+ * nothing left is shared by DICT_TRAIN_MIN_SAMPLES samples.
+ *
+ * @param dict_ptr
+ * @param dict_cap at most DICT_MAX_SIZE is useful
+ * @param samples_ptr the samples back to back
+ * @param sample_sizes
+ * @param num_samples
+ * @return array_size_t dictionary size
+ */
+array_size_t cmprss_dict_train(buffer_element_t *dict_ptr, array_size_t dict_cap, const buffer_element_t *samples_ptr,
+                               const array_size_t *sample_sizes, uint32_t num_samples)
+{
+  static uint16_t freq[1u << DICT_TRAIN_TABLE_BITS];
+  static uint32_t last_sample[1u << DICT_TRAIN_TABLE_BITS];
+  const buffer_element_t *sample_ptr = NULL, *best_ptr = NULL;
+  array_size_t dict_size = 0, segment = 0, window = 0, best_len = 0;
+  uint64_t score = 0, best_score = 0;
+  uint32_t h = 0;
+
+  memset(freq, 0, sizeof(freq));
+  memset(last_sample, 0, sizeof(last_sample));
+
+  // in how many samples does each k-mer appear
+  sample_ptr = samples_ptr;
+  for (uint32_t s = 0; s < num_samples; s++)
+  {
+    for (array_size_t p = 0; (p + DICT_TRAIN_KMER) <= sample_sizes[s]; p++)
+    {
+      h = kmer_hash(&sample_ptr[p]);
+      if (last_sample[h] != (s + 1))
+      {
+        last_sample[h] = s + 1;
+        if (freq[h] < UINT16_MAX)
+          freq[h]++;
+      }
+    }
+    sample_ptr += sample_sizes[s];
+  }
+  for (uint32_t k = 0; k < (1u << DICT_TRAIN_TABLE_BITS); k++)
+  {
+    if (freq[k] < DICT_TRAIN_MIN_SAMPLES)
+      freq[k] = 0;
+  }
+
+  while ((dict_size + DICT_TRAIN_KMER) <= dict_cap)
+  {
+    segment = dict_cap - dict_size;
+    if (segment > DICT_TRAIN_SEGMENT)
+      segment = DICT_TRAIN_SEGMENT;
+
+    best_score = 0;
+    sample_ptr = samples_ptr;
+    for (uint32_t s = 0; s < num_samples; s++)
+    {
+      window = (sample_sizes[s] < segment) ? sample_sizes[s] : segment;
+      if (window >= DICT_TRAIN_KMER)
+      {
+        // sliding sum over the k-mers which fit in the window
+        score = 0;
+        for (array_size_t p = 0; (p + DICT_TRAIN_KMER) <= window; p++)
+          score += freq[kmer_hash(&sample_ptr[p])];
+
+        for (array_size_t start = 0; ; start++)
+        {
+          if (score > best_score)
+          {
+            best_score = score;
+            best_ptr = &sample_ptr[start];
+            best_len = window;
+          }
+          if ((start + window) >= sample_sizes[s])
+            break;
+          score -= freq[kmer_hash(&sample_ptr[start])];
+          score += freq[kmer_hash(&sample_ptr[start + window + 1 - DICT_TRAIN_KMER])];
+        }
+      }
+      sample_ptr += sample_sizes[s];
+    }
+
+    if (best_score == 0)
+      break;
+
+    memcpy(&dict_ptr[dict_size], best_ptr, best_len);
+    dict_size += best_len;
+    for (array_size_t p = 0; (p + DICT_TRAIN_KMER) <= best_len; p++)
+      freq[kmer_hash(&best_ptr[p])] = 0;
+  }
+
+  return dict_size;
+}
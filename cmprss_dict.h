@@ -0,0 +1,44 @@
+#ifndef CMPRSS_DICT_H
+#define CMPRSS_DICT_H
+#include <stdint.h>
+
+#include "compression_test.h"
+
+// dictionary references carry a 16 bit offset, the index keeps positions + 1 in 16 bits
+#define DICT_MAX_SIZE 8192
+// shortest match the index can find, every position is hashed on its first DICT_HASH_BYTES bytes
+#define DICT_HASH_BYTES 4
+#define DICT_HASH_BITS 12
+#define DICT_HASH_SIZE (1u << DICT_HASH_BITS)
+// candidates tried per lookup, newest first
+#define DICT_MAX_CHAIN 32
+
+// cmprss_dict_train defaults, see the dictionary page
+#define DICT_TRAIN_SIZE 1024
+#define DICT_TRAIN_SEGMENT 48
+#define DICT_TRAIN_KMER 6
+// k-mers seen in fewer samples than this never make it into the dictionary
+#define DICT_TRAIN_MIN_SAMPLES 2
+#define DICT_TRAIN_TABLE_BITS 16
+
+/**
+ * @brief a loaded dictionary. Both sides load the same bytes once, the decoder only reads data/size,
+ * the encoder also uses the hash chains to find matches
+ *
+ */
+typedef struct
+{
+  buffer_element_t data[DICT_MAX_SIZE];
+  array_size_t size;
+  uint32_t id; // FNV-1a of the bytes, dictionary format streams carry its low 16 bits and the decoder checks them
+  uint16_t head[DICT_HASH_SIZE];
+  uint16_t chain[DICT_MAX_SIZE];
+} cmprss_dict_t;
+
+uint8_t cmprss_dict_load(cmprss_dict_t *dict, const buffer_element_t *data_ptr, array_size_t data_size);
+array_size_t cmprss_dict_find(const cmprss_dict_t *dict, const buffer_element_t *data_ptr, array_size_t data_size, array_size_t max_len,
+                              array_size_t *offset);
+array_size_t cmprss_dict_train(buffer_element_t *dict_ptr, array_size_t dict_cap, const buffer_element_t *samples_ptr,
+                               const array_size_t *sample_sizes, uint32_t num_samples);
+
+#endif //CMPRSS_DICT_H
@@ -0,0 +1,264 @@
+/**
+ * @file cmprss_dispatch.c
+ * @brief binds the best scan/decode kernels for this cpu once at startup
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * The codec calls getMatchLen, estimate_array_size, byte_decompress and the predictor's repeat count through cmprss_kernels, a table of
+ * function pointers filled in once by cmprss_dispatch_init. There is no feature check on the per call path.
+ * Set CMPRSS_KERNEL=<name> in the environment to force a kernel, e.g. to compare against the scalar reference.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cmprss_dispatch.h"
+#include "cmprss_test_data.h"
+#include "cmprss_predict.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CMPRSS_X86 1
+extern const cmprss_kernels_t cmprss_kernels_sse42;
+extern const cmprss_kernels_t cmprss_kernels_avx2;
+extern const cmprss_kernels_t cmprss_kernels_avx512;
+#endif
+
+// self test input, room for getMatchLen to look past the end of the largest array
+#define SELF_TEST_PAD 16
+// generated streams stop once they decode to MAX_INPUT_SIZE / 2, the worst case token is 1 + 7 + 47 bytes
+#define SELF_TEST_STREAM_SIZE (MAX_INPUT_SIZE * 2)
+
+static uint8_t scalar_supported(void)
+{
+  return 1;
+}
+
+#define SCALAR_KERNELS {"scalar", scalar_supported, getMatchLen, estimate_array_size, byte_decompress_scalar, cmprss_count_repeats_scalar}
+
+static const cmprss_kernels_t cmprss_kernels_scalar = SCALAR_KERNELS;
+
+// ordered worst to best, cmprss_dispatch_init takes the last one the cpu supports
+static const cmprss_kernels_t *const kernel_table[] = {
+  &cmprss_kernels_scalar,
+#ifdef CMPRSS_X86
+  &cmprss_kernels_sse42,
+  &cmprss_kernels_avx2,
+  &cmprss_kernels_avx512,
+#endif
+};
+#define NUM_KERNELS (sizeof(kernel_table) / sizeof(kernel_table[0]))
+
+cmprss_kernels_t cmprss_kernels = SCALAR_KERNELS;
+
+/**
+ * @brief looks up a kernel set by index, for the self test and benchmarks
+ *
+ * @param index
+ * @return const cmprss_kernels_t* NULL past the end of the table
+ */
+const cmprss_kernels_t *cmprss_dispatch_get(uint8_t index)
+{
+  if (index >= NUM_KERNELS)
+    return NULL;
+
+  return kernel_table[index];
+}
+
+/**
+ * @brief picks the best kernels the cpu supports, or the ones named by CMPRSS_KERNEL. Call once at startup,
+ * before any other thread is using the codec.
+ *
+ */
+void cmprss_dispatch_init(void)
+{
+  const cmprss_kernels_t *best = &cmprss_kernels_scalar;
+  const char *forced = getenv(CMPRSS_KERNEL_ENV);
+  uint8_t found = 0;
+
+#ifdef CMPRSS_X86
+  __builtin_cpu_init();
+#endif
+
+  for (uint8_t k = 0; k < NUM_KERNELS; k++)
+  {
+    if (kernel_table[k]->is_supported())
+      best = kernel_table[k];
+  }
+
+  if ((forced != NULL) && (forced[0] != '\0'))
+  {
+    for (uint8_t k = 0; k < NUM_KERNELS; k++)
+    {
+      if (strcmp(forced, kernel_table[k]->name) == 0)
+      {
+        found = 1;
+        if (kernel_table[k]->is_supported())
+          best = kernel_table[k];
+        else
+          printf("%s=%s is not supported on this cpu, using %s\n", CMPRSS_KERNEL_ENV, forced, best->name);
+      }
+    }
+    if (!found)
+      printf("%s=%s is not a known kernel, using %s\n", CMPRSS_KERNEL_ENV, forced, best->name);
+  }
+
+  cmprss_kernels = *best;
+}
+
+/**
+ * @brief builds a well formed compressed stream directly from the token rules in byte_decompress, so the decoder
+ * kernels get long unmatched stretches and every token shape without depending on byte_compress
+ *
+ * @param cmprss_ptr
+ * @param seed
+ * @return array_size_t size of the stream
+ */
+static array_size_t self_test_stream(buffer_element_t *cmprss_ptr, uint32_t seed)
+{
+  uint32_t state = (seed * 2654435761u) | 1;
+  array_size_t size = 0, out_size = 0, literals = 0;
+  cmprss_token_t token;
+  uint8_t before_matched = 0;
+
+  // a stream either starts with a sample byte and a matched before nibble, or straight on an 0x8# token
+  before_matched = (cmprss_test_rand(&state) & 1);
+  if (before_matched)
+    cmprss_ptr[size++] = (buffer_element_t)(cmprss_test_rand(&state) & MAX_NON_TOKEN_DATA);
+
+  // stay well inside the output buffer, the decoder only checks it once per token
+  while (out_size < (MAX_INPUT_SIZE / 2))
+  {
+    token.before = before_matched ? (1 + (cmprss_test_rand(&state) % NIBBLE_VALUE_MASK)) : NIBBLE_NON_MATCH_BIT;
+    out_size += before_matched ? (token.before & NIBBLE_VALUE_MASK) : literals;
+
+    if (cmprss_test_rand(&state) & 1)
+    {
+      // matched after: its sample, then the sample of the next token's matched before nibble
+      token.after = 1 + (cmprss_test_rand(&state) % NIBBLE_VALUE_MASK);
+      cmprss_ptr[size++] = token.byte;
+      cmprss_ptr[size++] = (buffer_element_t)(cmprss_test_rand(&state) & MAX_NON_TOKEN_DATA);
+      cmprss_ptr[size++] = (buffer_element_t)(cmprss_test_rand(&state) & MAX_NON_TOKEN_DATA);
+      out_size += token.after;
+      before_matched = 1;
+    }
+    else
+    {
+      // unmatched after: at least as many literals as the nibble says, then a token with the non-match bit set
+      token.after = NIBBLE_NON_MATCH_BIT | (1 + (cmprss_test_rand(&state) % NIBBLE_VALUE_MASK));
+      literals = (token.after & NIBBLE_VALUE_MASK) + (cmprss_test_rand(&state) % 48);
+      cmprss_ptr[size++] = token.byte;
+      for (array_size_t k = 0; k < literals; k++)
+        cmprss_ptr[size++] = (buffer_element_t)(cmprss_test_rand(&state) & MAX_NON_TOKEN_DATA);
+      before_matched = 0;
+    }
+  }
+
+  // end of stream, an unmatched before nibble collects the last literals
+  token.before = NIBBLE_NON_MATCH_BIT;
+  token.after = 0;
+  cmprss_ptr[size++] = token.byte;
+
+  return size;
+}
+
+/**
+ * @brief runs one kernel set against the scalar reference
+ *
+ * @param kernels
+ * @return uint8_t 1 if every result matched
+ */
+static uint8_t self_test_kernels(const cmprss_kernels_t *kernels)
+{
+  buffer_element_t input[MAX_INPUT_SIZE + SELF_TEST_PAD];
+  buffer_element_t cmprss[SELF_TEST_STREAM_SIZE];
+  buffer_element_t expected[MAX_INPUT_SIZE];
+  buffer_element_t actual[MAX_INPUT_SIZE];
+  cmprss_token_t ref_token, token;
+  int ref_size = 0, size = 0;
+  array_size_t cmprss_size = 0;
+  uint64_t checks = 0;
+
+  for (uint32_t seed = 1; seed <= SELF_TEST_SEEDS; seed++)
+  {
+    for (array_size_t data_size = 1; data_size <= MAX_INPUT_SIZE; data_size++)
+    {
+      memset(input, ERASED_BYTE, sizeof(input));
+      // runs long enough to hit the NIBBLE_VALUE_MASK cap, half of the seeds mostly unmatched
+      cmprss_test_fill_runs(input, data_size, SELF_TEST_SEED(seed, data_size), MAX_NON_TOKEN_DATA, ((seed & 1) != 0) ? 2 : (NIBBLE_MAX + 1));
+
+      for (array_size_t i = 0; i <= data_size; i++)
+      {
+        ref_token = getMatchLen(input, i, data_size);
+        token = kernels->match_len(input, i, data_size);
+        checks++;
+        if (ref_token.byte != token.byte)
+        {
+          print_array(input, data_size);
+          printf("%s match_len mismatch at %d of %d: 0x%X, scalar 0x%X\n", kernels->name, (int)i, (int)data_size, token.byte, ref_token.byte);
+          return 0;
+        }
+      }
+
+      ref_size = estimate_array_size(input, data_size);
+      size = kernels->estimate_size(input, data_size);
+      checks++;
+      if (ref_size != size)
+      {
+        print_array(input, data_size);
+        printf("%s estimate_size mismatch for size %d: %d, scalar %d\n", kernels->name, (int)data_size, size, ref_size);
+        return 0;
+      }
+
+      ref_size = (int)cmprss_count_repeats_scalar(input, data_size);
+      size = (int)kernels->count_repeats(input, data_size);
+      checks++;
+      if (ref_size != size)
+      {
+        print_array(input, data_size);
+        printf("%s count_repeats mismatch for size %d: %d, scalar %d\n", kernels->name, (int)data_size, size, ref_size);
+        return 0;
+      }
+
+      memset(cmprss, ERASED_BYTE, sizeof(cmprss));
+      cmprss_size = self_test_stream(cmprss, seed + (uint32_t)(data_size << 8));
+      memset(expected, 0, sizeof(expected));
+      memset(actual, 0, sizeof(actual));
+      ref_size = byte_decompress_scalar(expected, MAX_INPUT_SIZE, cmprss, cmprss_size);
+      size = kernels->decompress(actual, MAX_INPUT_SIZE, cmprss, cmprss_size);
+      checks++;
+      if ((ref_size != size) || (memcmp(expected, actual, MAX_INPUT_SIZE) != 0))
+      {
+        print_array(cmprss, cmprss_size);
+        printf("%s decompress mismatch: %d bytes, scalar %d bytes\n", kernels->name, size, ref_size);
+        return 0;
+      }
+    }
+  }
+
+  printf("kernel %s: %llu checks match scalar\n", kernels->name, (unsigned long long)checks);
+  return 1;
+}
+
+/**
+ * @brief test mode, runs every kernel set this cpu supports against the scalar reference
+ *
+ * @return uint8_t 1 if all of them matched
+ */
+uint8_t cmprss_dispatch_self_test(void)
+{
+  uint8_t result = 1;
+
+  printf("bound kernel: %s\n", cmprss_kernels.name);
+  for (uint8_t k = 1; k < NUM_KERNELS; k++)
+  {
+    if (!kernel_table[k]->is_supported())
+    {
+      printf("kernel %s: not supported, skipped\n", kernel_table[k]->name);
+      continue;
+    }
+    if (!self_test_kernels(kernel_table[k]))
+      result = 0;
+  }
+
+  return result;
+}
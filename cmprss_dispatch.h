@@ -0,0 +1,36 @@
+#ifndef CMPRSS_DISPATCH_H
+#define CMPRSS_DISPATCH_H
+#include <stdint.h>
+
+#include "compression_test.h"
+
+// environment variable which forces a kernel by name, e.g. CMPRSS_KERNEL=scalar
+#define CMPRSS_KERNEL_ENV "CMPRSS_KERNEL"
+
+typedef cmprss_token_t (*match_len_fn)(buffer_element_t *data_ptr, array_size_t i, array_size_t data_size);
+typedef int (*estimate_size_fn)(buffer_element_t *data_ptr, array_size_t data_size);
+typedef array_size_t (*count_repeats_fn)(const buffer_element_t *data_ptr, array_size_t data_size);
+typedef int (*decompress_fn)(buffer_element_t *uncmprss_data_ptr, array_size_t uncmprss_data_size, buffer_element_t *cmprss_data_ptr, array_size_t cmpress_data_size);
+
+/**
+ * @brief one set of scan/decode kernels, all built for the same instruction set
+ *
+ */
+typedef struct
+{
+  const char *name;
+  uint8_t (*is_supported)(void);
+  match_len_fn match_len;
+  estimate_size_fn estimate_size;
+  decompress_fn decompress;
+  count_repeats_fn count_repeats;
+} cmprss_kernels_t;
+
+// the kernels the codec calls through, scalar until cmprss_dispatch_init binds something better
+extern cmprss_kernels_t cmprss_kernels;
+
+void cmprss_dispatch_init(void);
+const cmprss_kernels_t *cmprss_dispatch_get(uint8_t index);
+uint8_t cmprss_dispatch_self_test(void);
+
+#endif //CMPRSS_DISPATCH_H
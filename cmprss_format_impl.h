@@ -0,0 +1,330 @@
+#ifndef CMPRSS_FORMAT_IMPL_H
+#define CMPRSS_FORMAT_IMPL_H
+#include <string.h>
+
+#include "cmprss_formats.h"
+
+/*
+ * Shared encoder and decoder bodies of the out of place token formats. cmprss_formats.c instantiates them once per
+ * format with DEFINE_FORMAT. The token layout is passed as constants and the bodies are force inlined, so every
+ * instantiation folds its masks, caps and token width into the code. Nothing is left to check per token and
+ * there are no bitfields. Only include this from cmprss_formats.c.
+ *
+ * A stream is a sequence of tokens, each token_bytes wide and stored most significant byte first:
+ *  - top bit set: literal, (length field + 1) raw bytes follow
+ *  - top bit clear: run, one byte follows which repeats (length field + min_run) times
+ *  - dictionary formats only, second bit set: (length field + min_match) bytes are copied from the dictionary,
+ *    a 16 bit offset into it follows
+ * The bits between the flags and the length field are always 0. Dictionary formats put the tag of the dictionary
+ * in front of the first token, see format_dict_tag.
+ */
+
+#ifndef CMPRSS_ALWAYS_INLINE
+#define CMPRSS_ALWAYS_INLINE static inline __attribute__((always_inline))
+#endif
+
+#define FORMAT_LITERAL_BIT(token_bytes) (1u << ((8u * (token_bytes)) - 1u))
+#define FORMAT_DICT_BIT(token_bytes) (FORMAT_LITERAL_BIT(token_bytes) >> 1)
+#define FORMAT_LEN_MASK(len_bits) ((1u << (len_bits)) - 1u)
+// a dictionary reference costs a token and 2 offset bytes, plus the token of the literals it splits
+#define FORMAT_MIN_MATCH(token_bytes) ((2u * (token_bytes)) + 2u)
+#define FORMAT_DICT_OFFSET_BYTES 2
+
+/**
+ * @brief the low 16 bits of cmprss_dict_t.id, never 0 because 0 marks a stream compressed without a dictionary
+ *
+ * @param dict NULL if none
+ * @return uint32_t
+ */
+CMPRSS_ALWAYS_INLINE uint32_t format_dict_tag(const cmprss_dict_t *dict)
+{
+  uint32_t tag = 0;
+
+  if (dict == NULL)
+    return 0;
+
+  tag = dict->id & 0xFFFFu;
+  return (tag != 0) ? tag : 1;
+}
+
+/**
+ * @brief writes one token, most significant byte first
+ *
+ * @param dst_ptr
+ * @param token
+ * @param token_bytes
+ */
+CMPRSS_ALWAYS_INLINE void format_put_token(buffer_element_t *dst_ptr, uint32_t token, const uint8_t token_bytes)
+{
+  if (token_bytes == 2)
+  {
+    dst_ptr[0] = (buffer_element_t)(token >> 8);
+    dst_ptr[1] = (buffer_element_t)token;
+  }
+  else
+  {
+    dst_ptr[0] = (buffer_element_t)token;
+  }
+}
+
+/**
+ * @brief reads one token, most significant byte first
+ *
+ * @param src_ptr
+ * @param token_bytes
+ * @return uint32_t
+ */
+CMPRSS_ALWAYS_INLINE uint32_t format_get_token(const buffer_element_t *src_ptr, const uint8_t token_bytes)
+{
+  if (token_bytes == 2)
+    return ((uint32_t)src_ptr[0] << 8) | src_ptr[1];
+
+  return src_ptr[0];
+}
+
+/**
+ * @brief writes the pending literals as literal tokens of at most 2^len_bits bytes each
+ *
+ * @param dst_ptr
+ * @param write_index in/out
+ * @param dst_cap
+ * @param literal_ptr
+ * @param literals
+ * @param token_bytes
+ * @param len_bits
+ * @return uint8_t 0 if they did not fit into dst_cap
+ */
+CMPRSS_ALWAYS_INLINE uint8_t format_put_literals(buffer_element_t *dst_ptr, array_size_t *write_index, array_size_t dst_cap,
+                                                 const buffer_element_t *literal_ptr, array_size_t literals,
+                                                 const uint8_t token_bytes, const uint8_t len_bits)
+{
+  const array_size_t max_literal = (array_size_t)FORMAT_LEN_MASK(len_bits) + 1;
+  array_size_t w = *write_index, chunk = 0;
+
+  while (literals > 0)
+  {
+    chunk = (literals < max_literal) ? literals : max_literal;
+    if ((dst_cap - w) < (token_bytes + chunk))
+      return 0;
+
+    format_put_token(&dst_ptr[w], FORMAT_LITERAL_BIT(token_bytes) | (uint32_t)(chunk - 1), token_bytes);
+    w += token_bytes;
+    memcpy(&dst_ptr[w], literal_ptr, chunk);
+    w += chunk;
+    literal_ptr += chunk;
+    literals -= chunk;
+  }
+
+  *write_index = w;
+  return 1;
+}
+
+/**
+ * @brief out of place encoder body, see cmprss_format_compress_dict
+ *
+ * @param dst_ptr
+ * @param dst_cap
+ * @param src_ptr
+ * @param src_size
+ * @param dict NULL to compress without dictionary references
+ * @param token_bytes 1 or 2
+ * @param len_bits width of the length field, at most 8 * token_bytes - 1
+ * @param min_run shortest run which gets a run token, shorter ones go out as literals. Above 2 * token_bytes,
+ * so a run token never costs more than the literals it replaces
+ * @param use_dict the format has dictionary references
+ * @return array_size_t compressed size, or CMPRSS_FORMAT_ERROR if dst_cap is too small
+ */
+CMPRSS_ALWAYS_INLINE array_size_t format_compress_impl(buffer_element_t *dst_ptr, array_size_t dst_cap, const buffer_element_t *src_ptr, array_size_t src_size,
+                                                       const cmprss_dict_t *dict, const uint8_t token_bytes, const uint8_t len_bits,
+                                                       const uint8_t min_run, const uint8_t use_dict)
+{
+  const array_size_t max_run = (array_size_t)FORMAT_LEN_MASK(len_bits) + min_run;
+  const array_size_t max_literal = (array_size_t)FORMAT_LEN_MASK(len_bits) + 1;
+  const array_size_t min_match = FORMAT_MIN_MATCH(token_bytes);
+  const array_size_t max_match = (array_size_t)FORMAT_LEN_MASK(len_bits) + min_match;
+  array_size_t i = 0, w = 0, run = 0, literal_start = 0, literals = 0, match = 0, offset = 0;
+  buffer_element_t value = 0;
+
+  if (use_dict)
+  {
+    if (dst_cap < CMPRSS_FORMAT_DICT_TAG_BYTES)
+      return CMPRSS_FORMAT_ERROR;
+    format_put_token(dst_ptr, format_dict_tag(dict), CMPRSS_FORMAT_DICT_TAG_BYTES);
+    w = CMPRSS_FORMAT_DICT_TAG_BYTES;
+  }
+
+  while (i < src_size)
+  {
+    value = src_ptr[i];
+    run = 1;
+    while ((run < max_run) && ((i + run) < src_size) && (src_ptr[i + run] == value))
+      run++;
+
+    // a reference has to cover more than the run token would
+    match = 0;
+    if (use_dict && (dict != NULL))
+      match = cmprss_dict_find(dict, &src_ptr[i], src_size - i, max_match, &offset);
+
+    if ((match >= min_match) && (match > run))
+    {
+      if (!format_put_literals(dst_ptr, &w, dst_cap, &src_ptr[literal_start], literals, token_bytes, len_bits))
+        return CMPRSS_FORMAT_ERROR;
+      literals = 0;
+
+      if ((dst_cap - w) < ((array_size_t)token_bytes + FORMAT_DICT_OFFSET_BYTES))
+        return CMPRSS_FORMAT_ERROR;
+      format_put_token(&dst_ptr[w], FORMAT_DICT_BIT(token_bytes) | (uint32_t)(match - min_match), token_bytes);
+      w += token_bytes;
+      dst_ptr[w++] = (buffer_element_t)(offset >> 8);
+      dst_ptr[w++] = (buffer_element_t)offset;
+      i += match;
+      continue;
+    }
+
+    if (run >= min_run)
+    {
+      if (!format_put_literals(dst_ptr, &w, dst_cap, &src_ptr[literal_start], literals, token_bytes, len_bits))
+        return CMPRSS_FORMAT_ERROR;
+      literals = 0;
+
+      if ((dst_cap - w) < ((array_size_t)token_bytes + 1))
+        return CMPRSS_FORMAT_ERROR;
+      format_put_token(&dst_ptr[w], (uint32_t)(run - min_run), token_bytes);
+      w += token_bytes;
+      dst_ptr[w++] = value;
+    }
+    else
+    {
+      // too short for a run token, the bytes join the pending literals
+      if (literals == 0)
+        literal_start = i;
+      literals += run;
+      if (literals >= max_literal)
+      {
+        if (!format_put_literals(dst_ptr, &w, dst_cap, &src_ptr[literal_start], max_literal, token_bytes, len_bits))
+          return CMPRSS_FORMAT_ERROR;
+        literal_start += max_literal;
+        literals -= max_literal;
+      }
+    }
+    i += run;
+  }
+
+  if (!format_put_literals(dst_ptr, &w, dst_cap, &src_ptr[literal_start], literals, token_bytes, len_bits))
+    return CMPRSS_FORMAT_ERROR;
+
+  return w;
+}
+
+/**
+ * @brief out of place decoder body, see cmprss_format_decompress_dict. Every read and write is bounds checked,
+ * a truncated or corrupt stream, or a reference past the end of the dictionary, gives CMPRSS_FORMAT_ERROR rather
+ * than touching memory outside the buffers. So does a dictionary stream whose tag is not the one of dict
+ *
+ * @param dst_ptr
+ * @param dst_cap
+ * @param src_ptr
+ * @param src_size
+ * @param dict the dictionary the stream was compressed with, NULL if none
+ * @param token_bytes
+ * @param len_bits
+ * @param min_run
+ * @param use_dict
+ * @return array_size_t decompressed size, or CMPRSS_FORMAT_ERROR
+ */
+CMPRSS_ALWAYS_INLINE array_size_t format_decompress_impl(buffer_element_t *dst_ptr, array_size_t dst_cap, const buffer_element_t *src_ptr, array_size_t src_size,
+                                                         const cmprss_dict_t *dict, const uint8_t token_bytes, const uint8_t len_bits,
+                                                         const uint8_t min_run, const uint8_t use_dict)
+{
+  const uint32_t literal_bit = FORMAT_LITERAL_BIT(token_bytes);
+  const uint32_t dict_bit = FORMAT_DICT_BIT(token_bytes);
+  const uint32_t len_mask = FORMAT_LEN_MASK(len_bits);
+  array_size_t r = 0, w = 0, len = 0, offset = 0;
+  uint32_t token = 0, kind = 0;
+
+  // a stream without a dictionary has no references and decodes with any, or none
+  if (use_dict)
+  {
+    if (src_size < CMPRSS_FORMAT_DICT_TAG_BYTES)
+      return CMPRSS_FORMAT_ERROR;
+    token = format_get_token(src_ptr, CMPRSS_FORMAT_DICT_TAG_BYTES);
+    if ((token != 0) && (token != format_dict_tag(dict)))
+      return CMPRSS_FORMAT_ERROR;
+    r = CMPRSS_FORMAT_DICT_TAG_BYTES;
+  }
+
+  while (r < src_size)
+  {
+    if ((src_size - r) < token_bytes)
+      return CMPRSS_FORMAT_ERROR;
+    token = format_get_token(&src_ptr[r], token_bytes);
+    r += token_bytes;
+
+    // exactly one flag or none, the bits between the flags and the length field unused
+    kind = token & ~len_mask;
+    if (kind == literal_bit)
+    {
+      len = (array_size_t)(token & len_mask) + 1;
+      if (((src_size - r) < len) || ((dst_cap - w) < len))
+        return CMPRSS_FORMAT_ERROR;
+      memcpy(&dst_ptr[w], &src_ptr[r], len);
+      r += len;
+    }
+    else if (use_dict && (kind == dict_bit))
+    {
+      len = (array_size_t)(token & len_mask) + FORMAT_MIN_MATCH(token_bytes);
+      if ((dict == NULL) || ((src_size - r) < FORMAT_DICT_OFFSET_BYTES) || ((dst_cap - w) < len))
+        return CMPRSS_FORMAT_ERROR;
+      offset = ((array_size_t)src_ptr[r] << 8) | src_ptr[r + 1];
+      if ((offset > dict->size) || ((dict->size - offset) < len))
+        return CMPRSS_FORMAT_ERROR;
+      memcpy(&dst_ptr[w], &dict->data[offset], len);
+      r += FORMAT_DICT_OFFSET_BYTES;
+    }
+    else if (kind == 0)
+    {
+      len = (array_size_t)token + min_run;
+      if ((r >= src_size) || ((dst_cap - w) < len))
+        return CMPRSS_FORMAT_ERROR;
+      memset(&dst_ptr[w], src_ptr[r], len);
+      r++;
+    }
+    else
+    {
+      return CMPRSS_FORMAT_ERROR;
+    }
+    w += len;
+  }
+
+  return w;
+}
+
+/**
+ * @brief generates the compress/decompress pair and the table entry of one format. The name becomes the suffix of
+ * the functions and of the cmprss_format_t
+ */
+#define DEFINE_FORMAT(NAME, ID, TOKEN_BYTES, LEN_BITS, MIN_RUN, USE_DICT)                                                 \
+_Static_assert((LEN_BITS) <= ((8 * (TOKEN_BYTES)) - 1 - (USE_DICT)), #NAME " length field does not fit next to the flags"); \
+_Static_assert(((TOKEN_BYTES) == 1) || ((TOKEN_BYTES) == 2), #NAME " tokens are 1 or 2 bytes");                           \
+_Static_assert((MIN_RUN) > (2 * (TOKEN_BYTES)), #NAME " run token plus the literal token it splits must not cost more " \
+                                                 "than the run, cmprss_format_bound relies on it");                       \
+_Static_assert(!(USE_DICT) || (FORMAT_MIN_MATCH(TOKEN_BYTES) >= DICT_HASH_BYTES), #NAME " matches shorter than the "    \
+                                                                                   "dictionary index can find");           \
+static array_size_t format_compress_##NAME(buffer_element_t *dst_ptr, array_size_t dst_cap,                              \
+                                           const buffer_element_t *src_ptr, array_size_t src_size,                       \
+                                           const cmprss_dict_t *dict)                                                     \
+{                                                                                                                         \
+  return format_compress_impl(dst_ptr, dst_cap, src_ptr, src_size, dict, TOKEN_BYTES, LEN_BITS, MIN_RUN, USE_DICT);       \
+}                                                                                                                         \
+static array_size_t format_decompress_##NAME(buffer_element_t *dst_ptr, array_size_t dst_cap,                            \
+                                             const buffer_element_t *src_ptr, array_size_t src_size,                     \
+                                             const cmprss_dict_t *dict)                                                   \
+{                                                                                                                         \
+  return format_decompress_impl(dst_ptr, dst_cap, src_ptr, src_size, dict, TOKEN_BYTES, LEN_BITS, MIN_RUN, USE_DICT);     \
+}                                                                                                                         \
+static const cmprss_format_t cmprss_format_##NAME = {#NAME, ID, TOKEN_BYTES, LEN_BITS, MIN_RUN, USE_DICT,                 \
+                                                     FORMAT_LEN_MASK(LEN_BITS) + (MIN_RUN), FORMAT_LEN_MASK(LEN_BITS) + 1,  \
+                                                     (USE_DICT) ? (FORMAT_LEN_MASK(LEN_BITS) + FORMAT_MIN_MATCH(TOKEN_BYTES)) : 0, \
+                                                     format_compress_##NAME, format_decompress_##NAME};
+
+#endif //CMPRSS_FORMAT_IMPL_H
@@ -0,0 +1,345 @@
+/**
+ * @file cmprss_formats.c
+ * @brief compile time specialized token formats, picked at runtime by format ID
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * The nibble token of byte_compress caps runs at 7 and needs 7-bit input, which suits some channels better than
+ * others. The formats here are out of place run length codecs that share one encoder and one decoder body
+ * (cmprss_format_impl.h). Each variant is generated with its own token width, length field and minimum run, so
+ * every one of them compiles down to constants. A channel stores its format ID and both sides look the codec up
+ * with cmprss_format_get. Adding a variant is one DEFINE_FORMAT line, a new ID and a table entry.
+ * Dictionary formats also reference a shared cmprss_dict_t, for short messages which have too little history of
+ * their own, see cmprss_dict.c.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "cmprss_formats.h"
+#include "cmprss_format_impl.h"
+#include "cmprss_test_data.h"
+
+// large enough for a few maximum length runs of the 16 bit format
+#define SELF_TEST_LARGE_SIZE (1u << 17)
+// streams up to this size also get every truncation decoded
+#define SELF_TEST_TRUNCATE_SIZE 64
+#define SELF_TEST_DICT_SIZE 1024
+
+//            name       ID                      token bytes  length bits  min run  dictionary
+DEFINE_FORMAT(run10,     CMPRSS_FORMAT_RUN10,    1,           3,           3,       0)
+DEFINE_FORMAT(run18,     CMPRSS_FORMAT_RUN18,    1,           4,           3,       0)
+DEFINE_FORMAT(run130,    CMPRSS_FORMAT_RUN130,   1,           7,           3,       0)
+DEFINE_FORMAT(run32772,  CMPRSS_FORMAT_RUN32772, 2,           15,          5,       0)
+DEFINE_FORMAT(dict66,    CMPRSS_FORMAT_DICT66,   1,           6,           3,       1)
+
+// indexed by format ID
+static const cmprss_format_t *const format_table[NUM_CMPRSS_FORMATS] = {
+  [CMPRSS_FORMAT_NIBBLE] = NULL, // not behind this API, see cmprss_format_id_t
+  [CMPRSS_FORMAT_RUN10] = &cmprss_format_run10,
+  [CMPRSS_FORMAT_RUN18] = &cmprss_format_run18,
+  [CMPRSS_FORMAT_RUN130] = &cmprss_format_run130,
+  [CMPRSS_FORMAT_RUN32772] = &cmprss_format_run32772,
+  [CMPRSS_FORMAT_DICT66] = &cmprss_format_dict66,
+};
+
+static buffer_element_t self_test_input[SELF_TEST_LARGE_SIZE];
+static buffer_element_t self_test_cmprss[CMPRSS_FORMAT_MAX_OVERHEAD(SELF_TEST_LARGE_SIZE)];
+static buffer_element_t self_test_output[SELF_TEST_LARGE_SIZE];
+static cmprss_dict_t self_test_dict;
+static cmprss_dict_t self_test_other_dict;
+
+/**
+ * @brief looks up a format by ID
+ *
+ * @param id
+ * @return const cmprss_format_t* NULL for CMPRSS_FORMAT_NIBBLE and unknown IDs
+ */
+const cmprss_format_t *cmprss_format_get(cmprss_format_id_t id)
+{
+  if ((unsigned)id >= NUM_CMPRSS_FORMATS)
+    return NULL;
+
+  return format_table[id];
+}
+
+/**
+ * @brief worst case compressed size, every byte a literal, plus the dictionary tag of the dictionary formats
+ *
+ * @param id
+ * @param src_size
+ * @return array_size_t 0 for an unknown ID
+ */
+array_size_t cmprss_format_bound(cmprss_format_id_t id, array_size_t src_size)
+{
+  const cmprss_format_t *format = cmprss_format_get(id);
+
+  if (format == NULL)
+    return 0;
+
+  return src_size + (((src_size + format->max_literal - 1) / format->max_literal) * format->token_bytes) +
+         (format->uses_dict ? CMPRSS_FORMAT_DICT_TAG_BYTES : 0);
+}
+
+/**
+ * @brief compresses src into dst in the format id. Unlike byte_compress the input is not modified and may hold any
+ * byte value
+ *
+ * @param id
+ * @param dst_ptr
+ * @param dst_cap cmprss_format_bound(id, src_size) always fits
+ * @param src_ptr
+ * @param src_size
+ * @return array_size_t compressed size, or CMPRSS_FORMAT_ERROR if it does not fit or the ID is unknown
+ */
+array_size_t cmprss_format_compress(cmprss_format_id_t id, buffer_element_t *dst_ptr, array_size_t dst_cap, const buffer_element_t *src_ptr, array_size_t src_size)
+{
+  const cmprss_format_t *format = cmprss_format_get(id);
+
+  if (format == NULL)
+    return CMPRSS_FORMAT_ERROR;
+
+  return format->compress(dst_ptr, dst_cap, src_ptr, src_size, NULL);
+}
+
+/**
+ * @brief decompresses a stream written by cmprss_format_compress with the same id
+ *
+ * @param id
+ * @param dst_ptr
+ * @param dst_cap
+ * @param src_ptr
+ * @param src_size
+ * @return array_size_t decompressed size, or CMPRSS_FORMAT_ERROR for a corrupt stream, a too small dst or an
+ * unknown ID
+ */
+array_size_t cmprss_format_decompress(cmprss_format_id_t id, buffer_element_t *dst_ptr, array_size_t dst_cap, const buffer_element_t *src_ptr, array_size_t src_size)
+{
+  const cmprss_format_t *format = cmprss_format_get(id);
+
+  if (format == NULL)
+    return CMPRSS_FORMAT_ERROR;
+
+  return format->decompress(dst_ptr, dst_cap, src_ptr, src_size, NULL);
+}
+
+/**
+ * @brief cmprss_format_compress with a dictionary. Formats without dictionary references ignore it
+ *
+ * @param id
+ * @param dict loaded with cmprss_dict_load, the decoder needs the same one
+ * @param dst_ptr
+ * @param dst_cap cmprss_format_bound(id, src_size) always fits
+ * @param src_ptr
+ * @param src_size
+ * @return array_size_t compressed size, or CMPRSS_FORMAT_ERROR if it does not fit or the ID is unknown
+ */
+array_size_t cmprss_format_compress_dict(cmprss_format_id_t id, const cmprss_dict_t *dict, buffer_element_t *dst_ptr, array_size_t dst_cap,
+                                         const buffer_element_t *src_ptr, array_size_t src_size)
+{
+  const cmprss_format_t *format = cmprss_format_get(id);
+
+  if (format == NULL)
+    return CMPRSS_FORMAT_ERROR;
+
+  return format->compress(dst_ptr, dst_cap, src_ptr, src_size, dict);
+}
+
+/**
+ * @brief decompresses a stream written by cmprss_format_compress_dict with the same id and dictionary
+ *
+ * @param id
+ * @param dict
+ * @param dst_ptr
+ * @param dst_cap
+ * @param src_ptr
+ * @param src_size
+ * @return array_size_t decompressed size, or CMPRSS_FORMAT_ERROR for a corrupt stream, a reference outside the
+ * dictionary, a stream compressed with another dictionary, a too small dst or an unknown ID
+ */
+array_size_t cmprss_format_decompress_dict(cmprss_format_id_t id, const cmprss_dict_t *dict, buffer_element_t *dst_ptr, array_size_t dst_cap,
+                                           const buffer_element_t *src_ptr, array_size_t src_size)
+{
+  const cmprss_format_t *format = cmprss_format_get(id);
+
+  if (format == NULL)
+    return CMPRSS_FORMAT_ERROR;
+
+  return format->decompress(dst_ptr, dst_cap, src_ptr, src_size, dict);
+}
+
+/**
+ * @brief fills the array with runs over the full byte range. The run lengths depend on the seed, from mostly
+ * unmatched up to runs past the longest cap
+ *
+ * @param data_ptr
+ * @param data_size
+ * @param seed
+ */
+static void self_test_fill(buffer_element_t *data_ptr, array_size_t data_size, uint32_t seed)
+{
+  static const uint32_t max_hold[4] = {3, 24, 300, 40000};
+
+  cmprss_test_fill_runs(data_ptr, data_size, seed, 0xFF, max_hold[seed & 3]);
+}
+
+/**
+ * @brief overwrites stretches of the array with pieces of the dictionary, so the dictionary formats get
+ * references of every length, next to runs and literals
+ *
+ * @param data_ptr
+ * @param data_size
+ * @param dict
+ * @param seed
+ */
+static void self_test_splice(buffer_element_t *data_ptr, array_size_t data_size, const cmprss_dict_t *dict, uint32_t seed)
+{
+  uint32_t state = (seed * 2246822519u) | 1;
+  array_size_t len = 0, offset = 0;
+
+  for (array_size_t k = 0; k < data_size; k += len)
+  {
+    cmprss_test_rand(&state);
+    len = 1 + ((state >> 4) % 80);
+    if ((len > (data_size - k)) || ((state & 3) == 0))
+      continue;
+
+    offset = (state >> 12) % (dict->size - len);
+    memcpy(&data_ptr[k], &dict->data[offset], len);
+  }
+}
+
+/**
+ * @brief round trips one input through a format, then checks the output cap and the decoder on every truncation
+ * of short streams
+ *
+ * @param format
+ * @param dict NULL to test without a dictionary
+ * @param data_size
+ * @param checks incremented per check
+ * @return uint8_t 1 if every check passed
+ */
+static uint8_t self_test_case(const cmprss_format_t *format, const cmprss_dict_t *dict, array_size_t data_size, uint64_t *checks)
+{
+  array_size_t bound = cmprss_format_bound(format->id, data_size);
+  array_size_t cmprss_size = 0, size = 0;
+
+  cmprss_size = format->compress(self_test_cmprss, bound, self_test_input, data_size, dict);
+  size = (cmprss_size > bound) ? CMPRSS_FORMAT_ERROR : format->decompress(self_test_output, data_size, self_test_cmprss, cmprss_size, dict);
+  (*checks)++;
+  if ((size != data_size) || (memcmp(self_test_input, self_test_output, data_size) != 0))
+  {
+    print_array(self_test_input, data_size);
+    printf("format %s round trip failed for size %d: compressed %lld, decompressed %lld\n", format->name, (int)data_size,
+           (long long)cmprss_size, (long long)size);
+    return 0;
+  }
+
+  // one byte short of the stream must be refused, not overrun
+  if (cmprss_size > 0)
+  {
+    (*checks)++;
+    if (format->compress(self_test_cmprss, cmprss_size - 1, self_test_input, data_size, dict) != CMPRSS_FORMAT_ERROR)
+    {
+      printf("format %s wrote past a %d byte cap\n", format->name, (int)(cmprss_size - 1));
+      return 0;
+    }
+  }
+
+  cmprss_size = format->compress(self_test_cmprss, bound, self_test_input, data_size, dict);
+  if (dict != NULL)
+  {
+    // the tag refuses the stream without the dictionary or with another one, references or not
+    size = format->decompress(self_test_output, data_size, self_test_cmprss, cmprss_size, NULL);
+    (*checks)++;
+    if (size != CMPRSS_FORMAT_ERROR)
+    {
+      printf("format %s decoded a dictionary stream without the dictionary to %d bytes\n", format->name, (int)size);
+      return 0;
+    }
+    size = format->decompress(self_test_output, data_size, self_test_cmprss, cmprss_size, &self_test_other_dict);
+    (*checks)++;
+    if (size != CMPRSS_FORMAT_ERROR)
+    {
+      printf("format %s decoded a dictionary stream with another dictionary to %d bytes\n", format->name, (int)size);
+      return 0;
+    }
+  }
+
+  if (cmprss_size > SELF_TEST_TRUNCATE_SIZE)
+    return 1;
+
+  // a cut stream either fails or decodes to a prefix of the input, it never runs past its buffers
+  for (array_size_t cut = 0; cut < cmprss_size; cut++)
+  {
+    size = format->decompress(self_test_output, data_size, self_test_cmprss, cut, dict);
+    (*checks)++;
+    if ((size != CMPRSS_FORMAT_ERROR) && ((size > data_size) || (memcmp(self_test_input, self_test_output, size) != 0)))
+    {
+      print_array(self_test_cmprss, cut);
+      printf("format %s decoded a %d byte cut to %d bytes which are not a prefix of the input\n", format->name, (int)cut, (int)size);
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+/**
+ * @brief test mode, round trips every format on generated runs of every size up to MAX_INPUT_SIZE and a few
+ * large buffers which hit the longest caps. Dictionary formats go through the same inputs again with pieces of
+ * a dictionary spliced in
+ *
+ * @return uint8_t 1 if all of them passed
+ */
+uint8_t cmprss_format_self_test(void)
+{
+  const cmprss_format_t *format = NULL;
+  uint8_t result = 1;
+  uint64_t checks = 0;
+
+  self_test_fill(self_test_input, SELF_TEST_DICT_SIZE, 0x5EED);
+  cmprss_dict_load(&self_test_dict, self_test_input, SELF_TEST_DICT_SIZE);
+  self_test_fill(self_test_input, SELF_TEST_DICT_SIZE, 0x5EEE);
+  cmprss_dict_load(&self_test_other_dict, self_test_input, SELF_TEST_DICT_SIZE);
+  if (format_dict_tag(&self_test_dict) == format_dict_tag(&self_test_other_dict))
+  {
+    printf("self test dictionaries share a tag\n");
+    return 0;
+  }
+
+  for (uint8_t id = 0; id < NUM_CMPRSS_FORMATS; id++)
+  {
+    if ((format = cmprss_format_get((cmprss_format_id_t)id)) == NULL)
+      continue;
+
+    checks = 0;
+    for (uint32_t seed = 1; (seed <= SELF_TEST_SEEDS) && result; seed++)
+    {
+      for (array_size_t data_size = 0; (data_size <= MAX_INPUT_SIZE) && result; data_size++)
+      {
+        self_test_fill(self_test_input, data_size, SELF_TEST_SEED(seed, data_size));
+        result = self_test_case(format, NULL, data_size, &checks);
+        if (result && format->uses_dict)
+        {
+          self_test_splice(self_test_input, data_size, &self_test_dict, SELF_TEST_SEED(seed, data_size));
+          result = self_test_case(format, &self_test_dict, data_size, &checks);
+        }
+      }
+
+      self_test_fill(self_test_input, SELF_TEST_LARGE_SIZE, seed);
+      if (result)
+        result = self_test_case(format, NULL, SELF_TEST_LARGE_SIZE, &checks);
+      if (result && format->uses_dict)
+      {
+        self_test_splice(self_test_input, SELF_TEST_LARGE_SIZE, &self_test_dict, seed);
+        result = self_test_case(format, &self_test_dict, SELF_TEST_LARGE_SIZE, &checks);
+      }
+    }
+
+    if (!result)
+      return 0;
+    printf("format %s: %llu checks pass\n", format->name, (unsigned long long)checks);
+  }
+
+  return result;
+}
@@ -0,0 +1,71 @@
+#ifndef CMPRSS_FORMATS_H
+#define CMPRSS_FORMATS_H
+#include <stdint.h>
+
+#include "compression_test.h"
+#include "cmprss_dict.h"
+
+// returned by the format codecs when the output does not fit or the stream is corrupt
+#define CMPRSS_FORMAT_ERROR ((array_size_t)-1)
+// dictionary format streams start with the low 16 bits of cmprss_dict_t.id, so a decoder holding another
+// dictionary refuses them
+#define CMPRSS_FORMAT_DICT_TAG_BYTES 2
+// cmprss_format_bound never needs more than this per input byte, the narrowest format adds a token per 8 literals
+#define CMPRSS_FORMAT_MAX_OVERHEAD(size) ((size) + ((size) / 8) + 2 + CMPRSS_FORMAT_DICT_TAG_BYTES)
+
+/**
+ * @brief format IDs, stored next to a channel's data so the decoder picks the same variant. The values go over the
+ * wire, do not renumber them.
+ * 0 is the in place nibble format of byte_compress/byte_decompress and is not selectable here: cmprss_format_get
+ * returns NULL for it and cmprss_format_compress/cmprss_format_decompress refuse it with CMPRSS_FORMAT_ERROR. The
+ * formats behind this API take any byte value and never touch memory outside their buffers, byte_compress only takes
+ * 7-bit samples, works in place and still crashes on some inputs (see the verification results on the testing page).
+ * A channel on ID 0 calls byte_compress/byte_decompress directly and keeps the raw block for when they fail, the way
+ * the pipeline does
+ *
+ */
+typedef enum
+{
+  CMPRSS_FORMAT_NIBBLE = 0, // byte_compress, reserved, not selectable through cmprss_format_get
+  CMPRSS_FORMAT_RUN10,      // 8 bit token, 3 bit length: runs 3..10, literals 1..8, the nibble caps
+  CMPRSS_FORMAT_RUN18,      // 8 bit token, 4 bit length: runs 3..18, literals 1..16
+  CMPRSS_FORMAT_RUN130,     // 8 bit token, 7 bit length: runs 3..130, literals 1..128
+  CMPRSS_FORMAT_RUN32772,   // 16 bit token, 15 bit length: runs 5..32772, literals 1..32768
+  CMPRSS_FORMAT_DICT66,     // 8 bit token, 6 bit length: runs 3..66, literals 1..64, dictionary references 4..67
+  NUM_CMPRSS_FORMATS
+} cmprss_format_id_t;
+
+typedef array_size_t (*format_codec_fn)(buffer_element_t *dst_ptr, array_size_t dst_cap, const buffer_element_t *src_ptr, array_size_t src_size,
+                                        const cmprss_dict_t *dict);
+
+/**
+ * @brief one token format, generated from the shared bodies in cmprss_format_impl.h
+ *
+ */
+typedef struct
+{
+  const char *name;
+  cmprss_format_id_t id;
+  uint8_t token_bytes;
+  uint8_t len_bits;
+  uint8_t min_run;
+  uint8_t uses_dict;
+  uint32_t max_run;
+  uint32_t max_literal;
+  uint32_t max_match; // longest dictionary reference, 0 for formats without them
+  format_codec_fn compress;
+  format_codec_fn decompress;
+} cmprss_format_t;
+
+// NULL for CMPRSS_FORMAT_NIBBLE and unknown IDs
+const cmprss_format_t *cmprss_format_get(cmprss_format_id_t id);
+array_size_t cmprss_format_bound(cmprss_format_id_t id, array_size_t src_size);
+array_size_t cmprss_format_compress(cmprss_format_id_t id, buffer_element_t *dst_ptr, array_size_t dst_cap, const buffer_element_t *src_ptr, array_size_t src_size);
+array_size_t cmprss_format_decompress(cmprss_format_id_t id, buffer_element_t *dst_ptr, array_size_t dst_cap, const buffer_element_t *src_ptr, array_size_t src_size);
+array_size_t cmprss_format_compress_dict(cmprss_format_id_t id, const cmprss_dict_t *dict, buffer_element_t *dst_ptr, array_size_t dst_cap,
+                                         const buffer_element_t *src_ptr, array_size_t src_size);
+array_size_t cmprss_format_decompress_dict(cmprss_format_id_t id, const cmprss_dict_t *dict, buffer_element_t *dst_ptr, array_size_t dst_cap,
+                                           const buffer_element_t *src_ptr, array_size_t src_size);
+uint8_t cmprss_format_self_test(void);
+
+#endif //CMPRSS_FORMATS_H
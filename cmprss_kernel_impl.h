@@ -0,0 +1,212 @@
+#ifndef CMPRSS_KERNEL_IMPL_H
+#define CMPRSS_KERNEL_IMPL_H
+#include <string.h>
+
+#include "cmprss_dispatch.h"
+#include "cmprss_prof.h"
+
+/*
+ * Shared bodies of the estimate and decompress kernels. Each instruction set includes this file and
+ * instantiates the bodies with its own primitives. The bodies are force inlined and the primitives are passed
+ * as constants, so every instantiation ends up with direct (usually inlined) calls and no per-call branching.
+ * Only include this from kernel translation units.
+ */
+
+#define CMPRSS_ALWAYS_INLINE static inline __attribute__((always_inline))
+
+typedef array_size_t (*find_token_fn)(buffer_element_t *cmprss_data_ptr, array_size_t start, array_size_t cmpress_data_size);
+
+/**
+ * @brief index of the next token, the first byte with the non-match bit set in its before nibble (> 0x7F),
+ * or cmpress_data_size if there is none
+ *
+ * @param cmprss_data_ptr
+ * @param start
+ * @param cmpress_data_size
+ * @return array_size_t
+ */
+CMPRSS_ALWAYS_INLINE array_size_t find_token_scalar(buffer_element_t *cmprss_data_ptr, array_size_t start, array_size_t cmpress_data_size)
+{
+  // ERASED_BYTE also has the bit set so it stops the scan too
+  while ((start < cmpress_data_size) && (cmprss_data_ptr[start] <= MAX_NON_TOKEN_DATA))
+    start++;
+
+  return start;
+}
+
+/**
+ * @brief number of neighbours which are equal, data_ptr[k] == data_ptr[k + 1] for k + 1 < data_size
+ *
+ * @param data_ptr
+ * @param data_size
+ * @return array_size_t
+ */
+CMPRSS_ALWAYS_INLINE array_size_t count_repeats_scalar_inline(const buffer_element_t *data_ptr, array_size_t data_size)
+{
+  array_size_t repeats = 0;
+
+  for (array_size_t k = 1; k < data_size; k++)
+    repeats += (data_ptr[k - 1] == data_ptr[k]);
+
+  return repeats;
+}
+
+/**
+ * @brief estimate_array_size body, see compression_test.c
+ *
+ * @param data_ptr
+ * @param data_size
+ * @param match_len
+ * @return int
+ */
+CMPRSS_ALWAYS_INLINE int estimate_array_size_impl(buffer_element_t *data_ptr, array_size_t data_size, match_len_fn match_len)
+{
+  array_size_t i = 0;
+  cmprss_token_t token1;
+  token1.before = NIBBLE_MAX;
+  token1.after = NIBBLE_MAX;
+  array_size_t itterationCount = data_size*2;
+  array_size_t cmprss_size_est = 0;
+
+  while ((i < data_size) && (data_ptr[i] != ERASED_BYTE))
+  {
+    //prefent infinite loop
+    itterationCount--;
+    if (itterationCount <=1)
+      break;
+
+    // get 2x consecutive sets of match/non-match sequences and set them as the lengths in the token along with their match bits
+    token1.before = match_len(data_ptr, i, data_size).after;
+    token1.after = match_len(data_ptr, i + (token1.before & NIBBLE_VALUE_MASK), data_size).after;
+
+    if ((token1.before & NIBBLE_NON_MATCH_BIT) != 0)
+    {
+      cmprss_size_est = cmprss_size_est + (token1.before & NIBBLE_VALUE_MASK) + 1;
+    }
+    else
+    {
+      cmprss_size_est = cmprss_size_est + 1;
+    }
+    i = i + (token1.before & NIBBLE_VALUE_MASK) + 1;
+
+    if ((token1.after & NIBBLE_NON_MATCH_BIT) != 0)
+    {
+      cmprss_size_est = cmprss_size_est + (token1.after & NIBBLE_VALUE_MASK) + 1;
+    }
+    else
+    {
+      cmprss_size_est = cmprss_size_est + 1;
+    }
+    i = i + (token1.after & NIBBLE_VALUE_MASK) + 1;
+
+    //for the token
+    cmprss_size_est = cmprss_size_est + 1;
+  }
+
+  return cmprss_size_est;
+}
+
+/**
+ * @brief byte_decompress body, see decompression_test.c
+ *
+ * @param uncmprss_data_ptr
+ * @param uncmprss_data_size
+ * @param cmprss_data_ptr
+ * @param cmpress_data_size
+ * @param find_token
+ * @return int
+ */
+CMPRSS_ALWAYS_INLINE int byte_decompress_impl(buffer_element_t *uncmprss_data_ptr, array_size_t uncmprss_data_size, buffer_element_t *cmprss_data_ptr, array_size_t cmpress_data_size,
+                                              find_token_fn find_token)
+{
+  array_size_t sizeAfterDecompression = 0;
+  array_size_t afterCopyIndex = 0, beforeCopyIndex = 0, readTokenIndex = 0, writeIndex = 0;
+  cmprss_token_t curToken;
+  curToken.byte = ERASED_BYTE;
+  uint16_t count = 0;
+
+  PROF_PHASE(PROF_DECODE_SCAN);
+
+  //* The first token will always be either in the first or second byte of the compressed array.
+  //      * If the first byte contains a value larger than 0x7F then the file starts with an unmatched string.
+  //      * If not, then the second byte is your first token.
+  if (cmprss_data_ptr[0] > MAX_NON_TOKEN_DATA)
+  {
+    curToken.byte = cmprss_data_ptr[0];
+    readTokenIndex = 0;
+  }
+  else
+  {
+    curToken.byte = cmprss_data_ptr[1];
+    readTokenIndex = 1;
+  }
+
+  while ((readTokenIndex < cmpress_data_size) && (cmprss_data_ptr[readTokenIndex] != ERASED_BYTE))
+  {
+    if (writeIndex >= uncmprss_data_size)
+    {
+        //error, uncmprss_array not large enough to hold uncmprss data
+        writeIndex = 0;
+        break;
+    }
+
+    if (count > (uncmprss_data_size+1))
+    {
+        break;
+    }
+    count++;
+    beforeCopyIndex = readTokenIndex - 1;
+
+    if ((curToken.before & NIBBLE_NON_MATCH_BIT) != 0)
+    {
+        // For an unmatched string,
+        //identify the next token and the end of the unmatched length and copy the unmatched length to the output without modification
+        //readTokenIndex should be at a token
+
+        PROF_SCOPE(PROF_DECODE_COPY, PROF_DECODE_SCAN, memmove(&uncmprss_data_ptr[writeIndex], &cmprss_data_ptr[afterCopyIndex], ((readTokenIndex)-(afterCopyIndex))));
+        writeIndex += ((readTokenIndex)-(afterCopyIndex));
+    }
+    else
+    {
+        // For a matched string,
+        //duplicate the next byte N times into the decompressed array.
+        PROF_SCOPE(PROF_DECODE_FILL, PROF_DECODE_SCAN, memset(&uncmprss_data_ptr[writeIndex], cmprss_data_ptr[beforeCopyIndex], (curToken.before & NIBBLE_VALUE_MASK)));
+        writeIndex += (curToken.before & NIBBLE_VALUE_MASK);
+    }
+    #ifdef DEBUG
+    print_array(uncmprss_data_ptr, writeIndex);
+    #endif
+
+    afterCopyIndex = readTokenIndex + 1;
+    if ((curToken.after & NIBBLE_NON_MATCH_BIT) != 0)
+    {
+        // For an unmatched string,
+        //Identify the start of the non-matching set
+        readTokenIndex += curToken.after & NIBBLE_VALUE_MASK;
+
+        //scan the following bytes for a value greater than 0x7F
+        readTokenIndex = find_token(cmprss_data_ptr, readTokenIndex, cmpress_data_size);
+    }
+    else
+    {
+        // For a matched string,
+        //duplicate the next byte N times into the decompressed array.
+        PROF_SCOPE(PROF_DECODE_FILL, PROF_DECODE_SCAN, memset(&uncmprss_data_ptr[writeIndex], cmprss_data_ptr[afterCopyIndex], (curToken.after & NIBBLE_VALUE_MASK)));
+        writeIndex += (curToken.after & NIBBLE_VALUE_MASK);
+
+        //Then skip the following byte in the compressed array to find your next token.
+        readTokenIndex += 3;
+    }
+    #ifdef DEBUG
+    print_array(uncmprss_data_ptr, writeIndex);
+    #endif
+    curToken.byte = cmprss_data_ptr[readTokenIndex];
+  }
+
+  sizeAfterDecompression = writeIndex;
+
+  PROF_STOP();
+  return sizeAfterDecompression;
+}
+
+#endif //CMPRSS_KERNEL_IMPL_H
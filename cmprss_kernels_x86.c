@@ -0,0 +1,196 @@
+/**
+ * @file cmprss_kernels_x86.c
+ * @brief SSE4.2, AVX2 and AVX-512BW versions of the scan/decode kernels
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * Every function carries its own target attribute, so this file builds with the same flags as the rest of the
+ * project and nothing here runs unless cmprss_dispatch_init found the instruction set on the cpu.
+ */
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+#include "cmprss_dispatch.h"
+#if DEBUG_OUTPUT == 1
+#define DEBUG 1
+#endif
+#include "cmprss_kernel_impl.h"
+
+#define TARGET_SSE42 __attribute__((target("sse4.2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+
+// getMatchLen never looks further than this many bytes past i, see NIBBLE_NON_MATCH_BIT
+#define MATCH_WINDOW 8
+// only pairs 0..6 are inside the window
+#define NIBBLE_MAX_STREAK_MASK ((1u << (NIBBLE_NON_MATCH_BIT - 1)) - 1)
+
+/**
+ * @brief vector getMatchLen, compares the whole 8 byte window at once instead of byte by byte
+ *
+ * A window is only 8 bytes so the 128 bit version is used by every instruction set, the wider
+ * kernels just get it VEX/EVEX encoded.
+ */
+#define DEFINE_MATCH_LEN(SUFFIX, TARGET)                                                                  \
+TARGET static cmprss_token_t match_len_##SUFFIX(buffer_element_t *data_ptr, array_size_t i, array_size_t data_size) \
+{                                                                                                         \
+  cmprss_token_t token1;                                                                                  \
+  __m128i window;                                                                                         \
+  uint32_t mask = 0;                                                                                      \
+                                                                                                          \
+  /* the ends of the array are rare, leave the bounds handling to the reference */                        \
+  if ((i + MATCH_WINDOW) > data_size)                                                                     \
+    return getMatchLen(data_ptr, i, data_size);                                                           \
+                                                                                                          \
+  token1.byte = 0;                                                                                        \
+  if (data_ptr[i] == ERASED_BYTE)                                                                         \
+    return token1;                                                                                        \
+                                                                                                          \
+  window = _mm_loadl_epi64((const __m128i *)&data_ptr[i]);                                                \
+  if (data_ptr[i] == data_ptr[i + 1])                                                                     \
+  {                                                                                                       \
+    /* bit j set when byte j matches byte 0, the run continues while they are set, up to 6 after byte 0 */ \
+    mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(window, _mm_set1_epi8((char)data_ptr[i])));        \
+    token1.after = 1 + __builtin_ctz(~(mask >> 1) | (1u << (NIBBLE_NON_MATCH_BIT - 2)));                  \
+  }                                                                                                       \
+  else                                                                                                    \
+  {                                                                                                       \
+    /* bit j set when byte j equals byte j+1, the unmatched streak ends at the first one, at most 7 long */ \
+    mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(window, _mm_srli_si128(window, 1)));                \
+    mask = (mask & NIBBLE_MAX_STREAK_MASK) | (1u << (NIBBLE_NON_MATCH_BIT - 1));                         \
+    token1.after = __builtin_ctz(mask) | NIBBLE_NON_MATCH_BIT;                                            \
+  }                                                                                                       \
+                                                                                                          \
+  return token1;                                                                                          \
+}
+
+DEFINE_MATCH_LEN(sse42, TARGET_SSE42)
+DEFINE_MATCH_LEN(avx2, TARGET_AVX2)
+DEFINE_MATCH_LEN(avx512, TARGET_AVX512)
+
+TARGET_SSE42 static array_size_t find_token_sse42(buffer_element_t *cmprss_data_ptr, array_size_t start, array_size_t cmpress_data_size)
+{
+  uint32_t mask = 0;
+
+  // a token is any byte with the top bit set, which is exactly what movemask collects
+  while ((start + 16) <= cmpress_data_size)
+  {
+    mask = (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)&cmprss_data_ptr[start]));
+    if (mask != 0)
+      return start + __builtin_ctz(mask);
+    start += 16;
+  }
+
+  return find_token_scalar(cmprss_data_ptr, start, cmpress_data_size);
+}
+
+TARGET_AVX2 static array_size_t find_token_avx2(buffer_element_t *cmprss_data_ptr, array_size_t start, array_size_t cmpress_data_size)
+{
+  uint32_t mask = 0;
+
+  while ((start + 32) <= cmpress_data_size)
+  {
+    mask = (uint32_t)_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i *)&cmprss_data_ptr[start]));
+    if (mask != 0)
+      return start + __builtin_ctz(mask);
+    start += 32;
+  }
+
+  return find_token_scalar(cmprss_data_ptr, start, cmpress_data_size);
+}
+
+TARGET_AVX512 static array_size_t find_token_avx512(buffer_element_t *cmprss_data_ptr, array_size_t start, array_size_t cmpress_data_size)
+{
+  uint64_t mask = 0;
+
+  while ((start + 64) <= cmpress_data_size)
+  {
+    mask = (uint64_t)_mm512_movepi8_mask(_mm512_loadu_si512((const void *)&cmprss_data_ptr[start]));
+    if (mask != 0)
+      return start + __builtin_ctzll(mask);
+    start += 64;
+  }
+
+  return find_token_scalar(cmprss_data_ptr, start, cmpress_data_size);
+}
+
+// each step compares a vector of bytes against the same vector shifted by one, k + 1 must stay inside the array
+TARGET_SSE42 static array_size_t count_repeats_sse42(const buffer_element_t *data_ptr, array_size_t data_size)
+{
+  array_size_t repeats = 0, k = 0;
+
+  for (; (k + 1 + 16) <= data_size; k += 16)
+    repeats += __builtin_popcount((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)&data_ptr[k]),
+                                                                            _mm_loadu_si128((const __m128i *)&data_ptr[k + 1]))));
+
+  return repeats + count_repeats_scalar_inline(&data_ptr[k], data_size - k);
+}
+
+TARGET_AVX2 static array_size_t count_repeats_avx2(const buffer_element_t *data_ptr, array_size_t data_size)
+{
+  array_size_t repeats = 0, k = 0;
+
+  for (; (k + 1 + 32) <= data_size; k += 32)
+    repeats += __builtin_popcount((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)&data_ptr[k]),
+                                                                                  _mm256_loadu_si256((const __m256i *)&data_ptr[k + 1]))));
+
+  return repeats + count_repeats_scalar_inline(&data_ptr[k], data_size - k);
+}
+
+TARGET_AVX512 static array_size_t count_repeats_avx512(const buffer_element_t *data_ptr, array_size_t data_size)
+{
+  array_size_t repeats = 0, k = 0;
+
+  __mmask64 tail = 0;
+
+  for (; (k + 1 + 64) <= data_size; k += 64)
+    repeats += __builtin_popcountll((uint64_t)_mm512_cmpeq_epi8_mask(_mm512_loadu_si512((const void *)&data_ptr[k]),
+                                                                     _mm512_loadu_si512((const void *)&data_ptr[k + 1])));
+
+  // masked loads never touch the bytes past the end, so the last pairs take one more step instead of a scalar loop
+  if ((k + 1) < data_size)
+  {
+    tail = (__mmask64)((1ull << (data_size - 1 - k)) - 1);
+    repeats += __builtin_popcountll((uint64_t)_mm512_mask_cmpeq_epi8_mask(tail, _mm512_maskz_loadu_epi8(tail, &data_ptr[k]),
+                                                                          _mm512_maskz_loadu_epi8(tail, &data_ptr[k + 1])));
+  }
+
+  return repeats;
+}
+
+#define DEFINE_KERNELS(SUFFIX, TARGET)                                                                    \
+TARGET static int estimate_size_##SUFFIX(buffer_element_t *data_ptr, array_size_t data_size)            \
+{                                                                                                         \
+  return estimate_array_size_impl(data_ptr, data_size, match_len_##SUFFIX);                              \
+}                                                                                                         \
+TARGET static int decompress_##SUFFIX(buffer_element_t *uncmprss_data_ptr, array_size_t uncmprss_data_size, \
+                                      buffer_element_t *cmprss_data_ptr, array_size_t cmpress_data_size) \
+{                                                                                                         \
+  return byte_decompress_impl(uncmprss_data_ptr, uncmprss_data_size, cmprss_data_ptr, cmpress_data_size, \
+                              find_token_##SUFFIX);                                                      \
+}
+
+DEFINE_KERNELS(sse42, TARGET_SSE42)
+DEFINE_KERNELS(avx2, TARGET_AVX2)
+DEFINE_KERNELS(avx512, TARGET_AVX512)
+
+static uint8_t sse42_supported(void)
+{
+  return __builtin_cpu_supports("sse4.2") != 0;
+}
+
+static uint8_t avx2_supported(void)
+{
+  return __builtin_cpu_supports("avx2") != 0;
+}
+
+static uint8_t avx512_supported(void)
+{
+  return (__builtin_cpu_supports("avx512f") != 0) && (__builtin_cpu_supports("avx512bw") != 0);
+}
+
+const cmprss_kernels_t cmprss_kernels_sse42 = {"sse4.2", sse42_supported, match_len_sse42, estimate_size_sse42, decompress_sse42, count_repeats_sse42};
+const cmprss_kernels_t cmprss_kernels_avx2 = {"avx2", avx2_supported, match_len_avx2, estimate_size_avx2, decompress_avx2, count_repeats_avx2};
+const cmprss_kernels_t cmprss_kernels_avx512 = {"avx512bw", avx512_supported, match_len_avx512, estimate_size_avx512, decompress_avx512, count_repeats_avx512};
+
+#endif // x86
@@ -0,0 +1,251 @@
+/**
+ * @file cmprss_pipeline.c
+ * @brief producer/consumer pipeline which moves byte_compress off of the sampling thread
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * The sampling thread pushes raw 7-bit samples into a single-producer/single-consumer ring.
+ * A background thread pulls them out in PIPELINE_BLOCK_SIZE blocks, compresses each block with
+ * byte_compress and publishes it on a second single-producer/single-consumer ring of blocks.
+ * The producer side never blocks and never allocates, when the raw ring is full the sample is dropped and counted.
+ */
+#include <string.h>
+#include <sched.h>
+
+#include "cmprss_pipeline.h"
+
+#define RAW_RING_MASK (PIPELINE_RAW_RING_SIZE - 1)
+#define OUT_RING_MASK (PIPELINE_OUT_RING_SIZE - 1)
+
+_Static_assert((PIPELINE_RAW_RING_SIZE & RAW_RING_MASK) == 0, "PIPELINE_RAW_RING_SIZE must be a power of 2");
+_Static_assert((PIPELINE_OUT_RING_SIZE & OUT_RING_MASK) == 0, "PIPELINE_OUT_RING_SIZE must be a power of 2");
+_Static_assert(PIPELINE_BLOCK_SIZE <= PIPELINE_RAW_RING_SIZE, "a block must fit in the raw ring");
+// a drained output ring must be able to take the whole raw ring plus a partial block, see cmprss_pipeline_stop
+_Static_assert(PIPELINE_OUT_RING_SIZE > (PIPELINE_RAW_RING_SIZE / PIPELINE_BLOCK_SIZE) + 1, "output ring too small to flush the raw ring");
+// byte_decompress checks its output size once per token, a bad block can still copy the whole compressed block
+// plus a run past raw_size, the round trip check decodes into a MAX_INPUT_SIZE buffer which has room for that
+_Static_assert(MAX_INPUT_SIZE >= ((PIPELINE_BLOCK_SIZE * 2) + NIBBLE_VALUE_MASK), "round trip check buffer too small for a bad block");
+
+/**
+ * @brief copies up to a block of samples out of the raw ring and releases their space to the producer
+ *
+ * @param ring
+ * @param block_ptr
+ * @param flush take a partial block, used when the pipeline is stopping
+ * @return array_size_t number of samples copied, 0 if a full block is not available yet
+ */
+static array_size_t raw_ring_take_block(sample_ring_t *ring, buffer_element_t *block_ptr, uint8_t flush)
+{
+  uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+  array_size_t available = (array_size_t)(ring->cached_head - tail);
+  array_size_t block_size = PIPELINE_BLOCK_SIZE;
+  array_size_t first_part = 0;
+
+  if (available < PIPELINE_BLOCK_SIZE)
+  {
+    ring->cached_head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    available = (array_size_t)(ring->cached_head - tail);
+  }
+
+  if (available < PIPELINE_BLOCK_SIZE)
+  {
+    if ((!flush) || (available == 0))
+      return 0;
+    block_size = available;
+  }
+
+  // the block may wrap around the end of the ring
+  first_part = PIPELINE_RAW_RING_SIZE - (tail & RAW_RING_MASK);
+  if (first_part > block_size)
+    first_part = block_size;
+  memcpy(block_ptr, &ring->data[tail & RAW_RING_MASK], first_part);
+  memcpy(&block_ptr[first_part], &ring->data[0], block_size - first_part);
+
+  atomic_store_explicit(&ring->tail, tail + block_size, memory_order_release);
+
+  return block_size;
+}
+
+/**
+ * @brief compresses one block into the next free slot of the output ring and publishes it
+ *
+ * byte_compress works in place and can leave the block corrupted when it fails, or hand back a block which does
+ * not decompress to its input. The raw samples are kept, every compressed block is decompressed again on this
+ * thread, and the block is stored uncompressed whenever compression does not reduce the size or does not round trip.
+ *
+ * @param pipeline
+ * @param raw_ptr
+ * @param raw_size
+ * @param seq
+ */
+static void publish_block(cmprss_pipeline_t *pipeline, buffer_element_t *raw_ptr, array_size_t raw_size, uint64_t seq)
+{
+  block_ring_t *ring = &pipeline->out;
+  uint64_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  cmprss_block_t *block = &ring->blocks[head & OUT_RING_MASK];
+  buffer_element_t check[MAX_INPUT_SIZE];
+  int cmprss_size = 0;
+  uint8_t round_trip = 0;
+
+  // the consumer is allowed to wait, only the producer side must never block
+  while ((head - atomic_load_explicit(&ring->tail, memory_order_acquire)) >= PIPELINE_OUT_RING_SIZE)
+    sched_yield();
+
+  memcpy(block->data, raw_ptr, raw_size);
+  memset(&block->data[raw_size], ERASED_BYTE, sizeof(block->data) - raw_size);
+  cmprss_size = byte_compress(block->data, raw_size);
+
+  // the consumer has time to spare, never publish a block the other end can not decode
+  if ((cmprss_size > 0) && ((array_size_t)cmprss_size < raw_size))
+  {
+    memset(check, ERASED_BYTE, sizeof(check));
+    round_trip = (byte_decompress(check, raw_size, block->data, (array_size_t)cmprss_size) == (int)raw_size) &&
+                 (memcmp(check, raw_ptr, raw_size) == 0);
+  }
+
+  if (!round_trip)
+  {
+    memcpy(block->data, raw_ptr, raw_size);
+    block->cmprss_size = raw_size;
+    atomic_fetch_add_explicit(&pipeline->blocks_stored, 1, memory_order_relaxed);
+  }
+  else
+  {
+    block->cmprss_size = (array_size_t)cmprss_size;
+    atomic_fetch_add_explicit(&pipeline->blocks_compressed, 1, memory_order_relaxed);
+  }
+  block->raw_size = raw_size;
+  block->seq = seq;
+
+  atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+/**
+ * @brief background consumer, compresses blocks until the pipeline is stopped and the raw ring is drained
+ *
+ * @param arg the cmprss_pipeline_t
+ * @return void*
+ */
+static void *consumer_thread(void *arg)
+{
+  cmprss_pipeline_t *pipeline = (cmprss_pipeline_t *)arg;
+  buffer_element_t raw_block[PIPELINE_BLOCK_SIZE];
+  array_size_t raw_size = 0;
+  uint64_t seq = 0;
+  uint8_t running = 1;
+
+  while (1)
+  {
+    running = atomic_load_explicit(&pipeline->running, memory_order_acquire);
+    raw_size = raw_ring_take_block(&pipeline->raw, raw_block, !running);
+
+    if (raw_size != 0)
+    {
+      publish_block(pipeline, raw_block, raw_size, seq++);
+    }
+    else if (!running)
+    {
+      break;
+    }
+    else
+    {
+      sched_yield();
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief resets the rings and starts the consumer thread
+ *
+ * The pipeline is caller owned (typically static) so nothing is allocated here either.
+ *
+ * @param pipeline
+ * @return int 0 on success, otherwise the pthread_create error
+ */
+int cmprss_pipeline_start(cmprss_pipeline_t *pipeline)
+{
+  atomic_init(&pipeline->raw.head, 0);
+  atomic_init(&pipeline->raw.tail, 0);
+  pipeline->raw.cached_head = 0;
+  pipeline->raw.cached_tail = 0;
+  atomic_init(&pipeline->out.head, 0);
+  atomic_init(&pipeline->out.tail, 0);
+  atomic_init(&pipeline->dropped_samples, 0);
+  atomic_init(&pipeline->blocks_compressed, 0);
+  atomic_init(&pipeline->blocks_stored, 0);
+  atomic_init(&pipeline->running, 1);
+
+  return pthread_create(&pipeline->consumer, NULL, consumer_thread, pipeline);
+}
+
+/**
+ * @brief producer side, queues one raw sample for compression. Never blocks.
+ *
+ * @param pipeline
+ * @param sample must be 0x00 to 0x7F
+ * @return uint8_t 1 if queued, 0 if dropped because the ring is full or the sample is out of range
+ */
+uint8_t cmprss_pipeline_push(cmprss_pipeline_t *pipeline, buffer_element_t sample)
+{
+  sample_ring_t *ring = &pipeline->raw;
+  uint64_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+  if (sample > MAX_NON_TOKEN_DATA)
+  {
+    atomic_fetch_add_explicit(&pipeline->dropped_samples, 1, memory_order_relaxed);
+    return 0;
+  }
+
+  // only re-read the consumer's tail when the cached copy says we are full, saves a cache miss per sample
+  if ((head - ring->cached_tail) >= PIPELINE_RAW_RING_SIZE)
+  {
+    ring->cached_tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if ((head - ring->cached_tail) >= PIPELINE_RAW_RING_SIZE)
+    {
+      atomic_fetch_add_explicit(&pipeline->dropped_samples, 1, memory_order_relaxed);
+      return 0;
+    }
+  }
+
+  ring->data[head & RAW_RING_MASK] = sample;
+  atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+
+  return 1;
+}
+
+/**
+ * @brief takes the oldest compressed block off of the output ring. Never blocks.
+ *
+ * @param pipeline
+ * @param block_out
+ * @return uint8_t 1 if a block was copied out, 0 if none is ready
+ */
+uint8_t cmprss_pipeline_pop_block(cmprss_pipeline_t *pipeline, cmprss_block_t *block_out)
+{
+  block_ring_t *ring = &pipeline->out;
+  uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+  if (tail == atomic_load_explicit(&ring->head, memory_order_acquire))
+    return 0;
+
+  memcpy(block_out, &ring->blocks[tail & OUT_RING_MASK], sizeof(cmprss_block_t));
+  atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+
+  return 1;
+}
+
+/**
+ * @brief stops the consumer once it has compressed everything pushed so far, including a final partial block
+ *
+ * Pop whatever blocks are ready before calling this, the output ring is sized so the flush of a full raw ring
+ * then always fits. The flushed blocks stay on the output ring for cmprss_pipeline_pop_block.
+ *
+ * @param pipeline
+ */
+void cmprss_pipeline_stop(cmprss_pipeline_t *pipeline)
+{
+  atomic_store_explicit(&pipeline->running, 0, memory_order_release);
+  pthread_join(pipeline->consumer, NULL);
+}
@@ -0,0 +1,58 @@
+#ifndef CMPRSS_PIPELINE_H
+#define CMPRSS_PIPELINE_H
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "compression_test.h"
+
+// both ring sizes must be powers of 2 so the free running indexes can be masked
+#define PIPELINE_RAW_RING_SIZE 4096
+#define PIPELINE_OUT_RING_SIZE 128
+#define PIPELINE_BLOCK_SIZE 64
+// getMatchLen looks up to a run length past the end of the block, keep that read inside the slot
+#define PIPELINE_BLOCK_PAD (NIBBLE_NON_MATCH_BIT + 1)
+#define PIPELINE_CACHE_LINE 64
+
+typedef struct
+{
+  uint64_t seq;
+  array_size_t raw_size;
+  array_size_t cmprss_size; // == raw_size when the block is stored uncompressed
+  buffer_element_t data[PIPELINE_BLOCK_SIZE + PIPELINE_BLOCK_PAD];
+} cmprss_block_t;
+
+typedef struct
+{
+  // head is only written by the producer, tail only by the consumer, keep them on separate cache lines
+  _Alignas(PIPELINE_CACHE_LINE) _Atomic uint64_t head;
+  uint64_t cached_tail;
+  _Alignas(PIPELINE_CACHE_LINE) _Atomic uint64_t tail;
+  uint64_t cached_head;
+  _Alignas(PIPELINE_CACHE_LINE) buffer_element_t data[PIPELINE_RAW_RING_SIZE];
+} sample_ring_t;
+
+typedef struct
+{
+  _Alignas(PIPELINE_CACHE_LINE) _Atomic uint64_t head;
+  _Alignas(PIPELINE_CACHE_LINE) _Atomic uint64_t tail;
+  _Alignas(PIPELINE_CACHE_LINE) cmprss_block_t blocks[PIPELINE_OUT_RING_SIZE];
+} block_ring_t;
+
+typedef struct
+{
+  sample_ring_t raw;
+  block_ring_t out;
+  pthread_t consumer;
+  _Atomic uint8_t running;
+  _Alignas(PIPELINE_CACHE_LINE) _Atomic uint64_t dropped_samples;
+  _Atomic uint64_t blocks_compressed;
+  _Atomic uint64_t blocks_stored;
+} cmprss_pipeline_t;
+
+int cmprss_pipeline_start(cmprss_pipeline_t *pipeline);
+uint8_t cmprss_pipeline_push(cmprss_pipeline_t *pipeline, buffer_element_t sample);
+uint8_t cmprss_pipeline_pop_block(cmprss_pipeline_t *pipeline, cmprss_block_t *block_out);
+void cmprss_pipeline_stop(cmprss_pipeline_t *pipeline);
+
+#endif //CMPRSS_PIPELINE_H
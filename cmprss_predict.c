@@ -0,0 +1,179 @@
+/**
+ * @file cmprss_predict.c
+ * @brief constant time compressibility predictor, lets byte_compress skip high entropy buffers
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * estimate_array_size walks the whole tokenization just to find out a buffer will not shrink. The predictor
+ * instead counts equal neighbours (the only thing this algorithm can compress) in PREDICT_WINDOWS fixed windows,
+ * so its cost does not depend on data_size. The repeat fraction gets a 99% Wilson interval, and the buffer is
+ * only called hopeless when even the upper end of that interval is below PREDICT_HOPELESS_PERMILLE.
+ */
+#include "cmprss_predict.h"
+#include "cmprss_dispatch.h"
+#include "cmprss_kernel_impl.h"
+
+#define PREDICT_Z2_X1000 ((PREDICT_Z_X1000 * PREDICT_Z_X1000) / 1000)
+
+uint8_t cmprss_predict_enabled = 1;
+
+/**
+ * @brief scalar reference for the count_repeats kernels
+ *
+ * @param data_ptr
+ * @param data_size
+ * @return array_size_t
+ */
+array_size_t cmprss_count_repeats_scalar(const buffer_element_t *data_ptr, array_size_t data_size)
+{
+  return count_repeats_scalar_inline(data_ptr, data_size);
+}
+
+/**
+ * @brief integer square root, keeps libm out of the build
+ *
+ * @param value
+ * @return uint64_t floor(sqrt(value))
+ */
+static uint64_t isqrt64(uint64_t value)
+{
+  uint64_t root = 0, bit = 1ull << 62;
+
+  while (bit > value)
+    bit >>= 2;
+
+  while (bit != 0)
+  {
+    if (value >= root + bit)
+    {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    }
+    else
+    {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+
+  return root;
+}
+
+/**
+ * @brief expected compressed size per 1000 input bytes for a repeat fraction
+ *
+ * @param repeat_permille
+ * @return uint16_t
+ */
+static uint16_t ratio_from_repeats(uint32_t repeat_permille)
+{
+  int32_t ratio = PREDICT_RATIO_INTERCEPT - (int32_t)((PREDICT_RATIO_SLOPE * repeat_permille) / 1000);
+
+  if (ratio < PREDICT_RATIO_MIN)
+    ratio = PREDICT_RATIO_MIN;
+
+  return (uint16_t)ratio;
+}
+
+/**
+ * @brief counts equal neighbours in the sampled windows
+ *
+ * @param data_ptr
+ * @param data_size at least 2
+ * @param pairs_ptr set to the number of neighbour pairs looked at
+ * @return uint64_t
+ */
+static uint64_t sample_repeats(const buffer_element_t *data_ptr, array_size_t data_size, uint64_t *pairs_ptr)
+{
+  uint64_t repeats = 0;
+
+  if (data_size <= (PREDICT_WINDOWS * PREDICT_WINDOW_SIZE))
+  {
+    *pairs_ptr = data_size - 1;
+    return cmprss_kernels.count_repeats(data_ptr, data_size);
+  }
+
+  // a window is PREDICT_WINDOW_SIZE pairs, one byte more than that. First and last window sit on the ends of the
+  // buffer, the others are spread evenly between them
+  for (array_size_t w = 0; w < PREDICT_WINDOWS; w++)
+    repeats += cmprss_kernels.count_repeats(&data_ptr[(w * (data_size - (PREDICT_WINDOW_SIZE + 1))) / (PREDICT_WINDOWS - 1)], PREDICT_WINDOW_SIZE + 1);
+  *pairs_ptr = PREDICT_WINDOWS * PREDICT_WINDOW_SIZE;
+
+  return repeats;
+}
+
+/**
+ * @brief is the upper Wilson bound on repeats / pairs below PREDICT_HOPELESS_PERMILLE
+ *
+ * The upper bound u solves n(u - p)^2 = z^2 u(1 - u) with u > p, so u < t exactly when p < t and
+ * n(t - p)^2 > z^2 t(1 - t). Squared out in integers that needs no division or square root, which keeps
+ * the byte_compress path cheap.
+ *
+ * @param repeats
+ * @param pairs
+ * @return uint8_t
+ */
+static uint8_t repeats_are_hopeless(uint64_t repeats, uint64_t pairs)
+{
+  uint64_t threshold = PREDICT_HOPELESS_PERMILLE * pairs, observed = repeats * 1000, gap = 0;
+
+  if (observed >= threshold)
+    return 0;
+
+  gap = threshold - observed;
+  return (gap * gap * 1000000) >
+         ((uint64_t)PREDICT_Z_X1000 * PREDICT_Z_X1000 * PREDICT_HOPELESS_PERMILLE * (1000 - PREDICT_HOPELESS_PERMILLE) * pairs);
+}
+
+/**
+ * @brief just the hopeless verdict of cmprss_predict, without the ratio estimate
+ *
+ * @param data_ptr
+ * @param data_size
+ * @return uint8_t 1 if the buffer will not shrink, store it as is
+ */
+uint8_t cmprss_predict_hopeless(const buffer_element_t *data_ptr, array_size_t data_size)
+{
+  uint64_t pairs = 0, repeats = 0;
+
+  if (data_size < 2)
+    return 0;
+
+  repeats = sample_repeats(data_ptr, data_size, &pairs);
+  return repeats_are_hopeless(repeats, pairs);
+}
+
+/**
+ * @brief samples the buffer and predicts how well byte_compress will do on it
+ *
+ * @param data_ptr
+ * @param data_size
+ * @return cmprss_prediction_t
+ */
+cmprss_prediction_t cmprss_predict(const buffer_element_t *data_ptr, array_size_t data_size)
+{
+  cmprss_prediction_t prediction = {0, 1000, 1000, 1000, 0};
+  uint64_t repeats = 0, pairs = 0, denom = 0, inner = 0;
+  int64_t center = 0, half = 0, low = 0, high = 0;
+
+  if (data_size < 2)
+    return prediction;
+
+  repeats = sample_repeats(data_ptr, data_size, &pairs);
+
+  // Wilson score interval, everything x1000 so it stays in integers
+  denom = (pairs * 1000) + PREDICT_Z2_X1000;
+  center = (int64_t)((((repeats * 1000) + (PREDICT_Z2_X1000 / 2)) * 1000) / denom);
+  inner = ((repeats * (pairs - repeats) * 1000000) / pairs) + (PREDICT_Z2_X1000 * 250);
+  half = (int64_t)((PREDICT_Z_X1000 * isqrt64(inner)) / denom);
+  low = (center > half) ? (center - half) : 0;
+  high = ((center + half) < 1000) ? (center + half) : 1000;
+
+  prediction.repeat_permille = (uint16_t)((repeats * 1000) / pairs);
+  prediction.ratio_permille = ratio_from_repeats(prediction.repeat_permille);
+  prediction.ratio_low_permille = ratio_from_repeats((uint32_t)high);
+  prediction.ratio_high_permille = ratio_from_repeats((uint32_t)low);
+  prediction.hopeless = repeats_are_hopeless(repeats, pairs);
+
+  return prediction;
+}
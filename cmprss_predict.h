@@ -0,0 +1,37 @@
+#ifndef CMPRSS_PREDICT_H
+#define CMPRSS_PREDICT_H
+#include <stdint.h>
+
+#include "compression_test.h"
+
+// fixed windows sampled by cmprss_predict, each PREDICT_WINDOW_SIZE neighbour pairs long. Buffers up to
+// PREDICT_WINDOWS * PREDICT_WINDOW_SIZE are read whole
+#define PREDICT_WINDOWS 4
+#define PREDICT_WINDOW_SIZE 32
+// z for the 99% confidence bounds, x1000
+#define PREDICT_Z_X1000 2576
+// below this many repeats per 1000 neighbours estimate_array_size (practically) never comes in under data_size
+#define PREDICT_HOPELESS_PERMILLE 120
+// expected compressed ratio from the repeat fraction p, ratio = (INTERCEPT - SLOPE * p) / 1000. Fitted against
+// estimate_array_size on generated run length data, see the benchmark page
+#define PREDICT_RATIO_INTERCEPT 1100
+#define PREDICT_RATIO_SLOPE 950
+#define PREDICT_RATIO_MIN 150
+
+typedef struct
+{
+  uint16_t repeat_permille;     // sampled neighbours which are equal, per 1000
+  uint16_t ratio_permille;      // expected compressed size per 1000 bytes of input
+  uint16_t ratio_low_permille;  // 99% confidence bounds on ratio_permille
+  uint16_t ratio_high_permille;
+  uint8_t hopeless;             // even the optimistic bound does not compress, store the buffer as is
+} cmprss_prediction_t;
+
+// byte_compress consults the predictor while this is set, the benchmarks clear it to time the full estimate path
+extern uint8_t cmprss_predict_enabled;
+
+uint8_t cmprss_predict_hopeless(const buffer_element_t *data_ptr, array_size_t data_size);
+cmprss_prediction_t cmprss_predict(const buffer_element_t *data_ptr, array_size_t data_size);
+array_size_t cmprss_count_repeats_scalar(const buffer_element_t *data_ptr, array_size_t data_size);
+
+#endif //CMPRSS_PREDICT_H
@@ -0,0 +1,345 @@
+/**
+ * @file cmprss_prof.c
+ * @brief per phase hardware counters for byte_compress/byte_decompress, enabled with PROFILE_PHASES
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * The codec marks every phase change with PROF_PHASE. Each mark reads the counters once and books everything
+ * since the previous mark to the phase which was running, so the phases add up to the whole call and nothing is
+ * counted twice. On Linux the counters are cycles, instructions, branch misses and L1D read misses from one
+ * perf_event_open group, read with rdpmc straight from user space where the kernel allows it and with read()
+ * otherwise. Without perf (no permission, a VM without a PMU, not Linux) only cycles are left, from rdtsc.
+ * The cost of a mark is measured by cmprss_prof_reset and taken back out before printing.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include "cmprss_prof.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PROF_X86 1
+#include <x86intrin.h>
+#endif
+
+#if defined(__linux__)
+#define PROF_PERF 1
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+// cmprss_prof_reset times this many rounds of switches and keeps the cheapest round as the cost of a switch, an
+// interrupt in one round must not inflate what gets taken out of every phase
+#define PROF_CALIBRATE_ROUNDS 32
+#define PROF_CALIBRATE_SWITCHES 256
+
+typedef enum
+{
+  SOURCE_CLOCK = 0,
+  SOURCE_TSC,
+  SOURCE_PERF_READ,
+  SOURCE_PERF_RDPMC,
+} prof_source_t;
+
+static const char *const phase_names[NUM_PROF_PHASES] = {"idle", "estimate", "tokenize", "shift/memmove", "decode scan", "decode fill", "decode copy"};
+static const char *const counter_names[NUM_PROF_COUNTERS] = {"cycles", "instructions", "branch-misses", "L1D misses"};
+static const char *const source_names[] = {"clock_gettime", "rdtsc", "perf_event_open, read()", "perf_event_open, rdpmc"};
+// what the cycles column holds for each source
+static const char *const cycle_units[] = {"ns", "tsc ticks", "cycles", "cycles"};
+
+static prof_source_t prof_source = SOURCE_CLOCK;
+static char prof_note[96] = "";
+static uint8_t prof_initialized = 0;
+static uint8_t prof_available[NUM_PROF_COUNTERS];
+// counters only count the thread which opened them, calls from any other thread (e.g. the pipeline consumer) are ignored
+static _Thread_local uint8_t prof_owner = 0;
+static cmprss_phase_t prof_current = PROF_IDLE;
+static uint64_t prof_last[NUM_PROF_COUNTERS];
+static uint64_t prof_totals[NUM_PROF_PHASES][NUM_PROF_COUNTERS];
+static uint64_t prof_entries[NUM_PROF_PHASES];
+static uint64_t prof_overhead[NUM_PROF_COUNTERS];
+
+#ifdef PROF_PERF
+static int prof_fd[NUM_PROF_COUNTERS] = {-1, -1, -1, -1};
+static struct perf_event_mmap_page *prof_page[NUM_PROF_COUNTERS];
+// position of each counter in a PERF_FORMAT_GROUP read, unavailable counters are not in the group
+static uint8_t prof_group_slot[NUM_PROF_COUNTERS];
+static uint8_t prof_group_size = 0;
+
+static int perf_open(uint32_t type, uint64_t config, int group_fd)
+{
+  struct perf_event_attr attr;
+
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  // the group starts disabled and is enabled as a whole once every counter is in it
+  attr.disabled = (group_fd == -1);
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP;
+
+  return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+static void perf_read_group(uint64_t *now)
+{
+  uint64_t values[1 + NUM_PROF_COUNTERS];
+
+  if (read(prof_fd[PROF_CYCLES], values, sizeof(uint64_t) * (1 + prof_group_size)) <= 0)
+    return;
+
+  for (uint8_t c = 0; c < NUM_PROF_COUNTERS; c++)
+  {
+    if (prof_available[c])
+      now[c] = values[1 + prof_group_slot[c]];
+  }
+}
+
+#ifdef PROF_X86
+/**
+ * @brief reads one counter without a system call, following the seqlock protocol of the perf mmap page
+ *
+ * @param page
+ * @return uint64_t
+ */
+static uint64_t perf_rdpmc(volatile struct perf_event_mmap_page *page)
+{
+  uint32_t seq = 0, index = 0;
+  uint64_t count = 0, pmc = 0;
+  uint16_t width = 0;
+
+  do
+  {
+    seq = page->lock;
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    index = page->index;
+    count = page->offset;
+    width = page->pmc_width;
+    if (index != 0)
+    {
+      // the hardware counter is only pmc_width bits wide, sign extend it before adding the kernel's offset
+      pmc = (uint64_t)__rdpmc((int)index - 1) << (64 - width);
+      count += (uint64_t)((int64_t)pmc >> (64 - width));
+    }
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+  } while (page->lock != seq);
+
+  return count;
+}
+#endif
+#endif // PROF_PERF
+
+static void read_counters(uint64_t *now)
+{
+  struct timespec ts;
+
+  switch (prof_source)
+  {
+#ifdef PROF_PERF
+#ifdef PROF_X86
+    case SOURCE_PERF_RDPMC:
+      for (uint8_t c = 0; c < NUM_PROF_COUNTERS; c++)
+      {
+        if (prof_available[c])
+          now[c] = perf_rdpmc(prof_page[c]);
+      }
+      break;
+#endif
+    case SOURCE_PERF_READ:
+      perf_read_group(now);
+      break;
+#endif
+#ifdef PROF_X86
+    case SOURCE_TSC:
+      now[PROF_CYCLES] = __rdtsc();
+      break;
+#endif
+    default:
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      now[PROF_CYCLES] = ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+      break;
+  }
+}
+
+/**
+ * @brief opens the counters for the calling thread, only that thread is profiled. Falls back to rdtsc when
+ * perf_event_open is not available.
+ *
+ */
+void cmprss_prof_init(void)
+{
+  prof_owner = 1;
+  if (prof_initialized)
+    return;
+  prof_initialized = 1;
+
+  memset(prof_available, 0, sizeof(prof_available));
+  prof_available[PROF_CYCLES] = 1;
+
+#ifdef PROF_PERF
+  static const uint32_t types[NUM_PROF_COUNTERS] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE};
+  static const uint64_t configs[NUM_PROF_COUNTERS] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES,
+    PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)};
+  long page_size = sysconf(_SC_PAGESIZE);
+  uint8_t user_rdpmc = 1;
+
+  prof_fd[PROF_CYCLES] = perf_open(types[PROF_CYCLES], configs[PROF_CYCLES], -1);
+  if (prof_fd[PROF_CYCLES] >= 0)
+  {
+    // the other counters are optional, e.g. not every PMU has an L1D read miss event
+    for (uint8_t c = 0; c < NUM_PROF_COUNTERS; c++)
+    {
+      if (c != PROF_CYCLES)
+        prof_fd[c] = perf_open(types[c], configs[c], prof_fd[PROF_CYCLES]);
+      if (prof_fd[c] < 0)
+        continue;
+
+      prof_available[c] = 1;
+      prof_group_slot[c] = prof_group_size++;
+      prof_page[c] = mmap(NULL, (size_t)page_size, PROT_READ, MAP_SHARED, prof_fd[c], 0);
+      if (prof_page[c] == MAP_FAILED)
+      {
+        prof_page[c] = NULL;
+        user_rdpmc = 0;
+      }
+    }
+
+    ioctl(prof_fd[PROF_CYCLES], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+    for (uint8_t c = 0; c < NUM_PROF_COUNTERS; c++)
+    {
+      if (prof_available[c] && ((prof_page[c] == NULL) || !prof_page[c]->cap_user_rdpmc))
+        user_rdpmc = 0;
+    }
+#ifdef PROF_X86
+    prof_source = user_rdpmc ? SOURCE_PERF_RDPMC : SOURCE_PERF_READ;
+#else
+    (void)user_rdpmc;
+    prof_source = SOURCE_PERF_READ;
+#endif
+    return;
+  }
+
+  snprintf(prof_note, sizeof(prof_note), ", perf_event_open: %s", strerror(errno));
+#endif
+
+#ifdef PROF_X86
+  prof_source = SOURCE_TSC;
+#else
+  prof_source = SOURCE_CLOCK;
+#endif
+}
+
+/**
+ * @brief switches the running phase, everything counted since the last switch goes to the phase that was running
+ *
+ * @param phase
+ */
+void cmprss_prof_switch(cmprss_phase_t phase)
+{
+  uint64_t now[NUM_PROF_COUNTERS] = {0};
+
+  if (!prof_owner)
+    return;
+
+  read_counters(now);
+  for (uint8_t c = 0; c < NUM_PROF_COUNTERS; c++)
+  {
+    prof_totals[prof_current][c] += now[c] - prof_last[c];
+    prof_last[c] = now[c];
+  }
+  prof_entries[phase]++;
+  prof_current = phase;
+}
+
+/**
+ * @brief clears the totals and measures what one switch costs, call it right before the code to profile
+ *
+ */
+void cmprss_prof_reset(void)
+{
+  uint64_t before[NUM_PROF_COUNTERS] = {0}, after[NUM_PROF_COUNTERS] = {0};
+
+  if (!prof_owner)
+    return;
+
+  memset(prof_overhead, 0xFF, sizeof(prof_overhead));
+  read_counters(prof_last);
+  for (uint32_t round = 0; round < PROF_CALIBRATE_ROUNDS; round++)
+  {
+    read_counters(before);
+    for (uint32_t k = 0; k < PROF_CALIBRATE_SWITCHES; k++)
+      cmprss_prof_switch(PROF_IDLE);
+    read_counters(after);
+
+    for (uint8_t c = 0; c < NUM_PROF_COUNTERS; c++)
+    {
+      if (((after[c] - before[c]) / PROF_CALIBRATE_SWITCHES) < prof_overhead[c])
+        prof_overhead[c] = (after[c] - before[c]) / PROF_CALIBRATE_SWITCHES;
+    }
+  }
+
+  memset(prof_totals, 0, sizeof(prof_totals));
+  memset(prof_entries, 0, sizeof(prof_entries));
+  prof_current = PROF_IDLE;
+  read_counters(prof_last);
+}
+
+static uint64_t phase_count(cmprss_phase_t phase, cmprss_counter_t counter)
+{
+  uint64_t overhead = prof_entries[phase] * prof_overhead[counter];
+
+  return (prof_totals[phase][counter] > overhead) ? (prof_totals[phase][counter] - overhead) : 0;
+}
+
+/**
+ * @brief prints the totals since cmprss_prof_reset as a markdown table, one row per phase
+ *
+ * @param title
+ */
+void cmprss_prof_print(const char *title)
+{
+  uint64_t total = 0, value = 0;
+
+  if (!prof_owner)
+    return;
+
+  for (uint8_t p = PROF_IDLE + 1; p < NUM_PROF_PHASES; p++)
+    total += phase_count((cmprss_phase_t)p, PROF_CYCLES);
+
+  printf("\n### Phase profile, %s\n", title);
+  printf("counters: %s%s, %llu per switch taken out\n", source_names[prof_source], prof_note, (unsigned long long)prof_overhead[PROF_CYCLES]);
+  printf("| %-13s | %9s | %12s | %9s | %6s |", "phase", "entries", cycle_units[prof_source], "per entry", "%");
+  for (uint8_t c = PROF_CYCLES + 1; c < NUM_PROF_COUNTERS; c++)
+    printf(" %13s |", counter_names[c]);
+  printf(" %5s |\n", "IPC");
+  printf("|---------------|-----------|--------------|-----------|--------|---------------|---------------|---------------|-------|\n");
+
+  for (uint8_t p = PROF_IDLE + 1; p < NUM_PROF_PHASES; p++)
+  {
+    if (prof_entries[p] == 0)
+      continue;
+
+    value = phase_count((cmprss_phase_t)p, PROF_CYCLES);
+    printf("| %-13s | %9llu | %12llu | %9.1f | %6.1f |", phase_names[p], (unsigned long long)prof_entries[p], (unsigned long long)value,
+           (double)value / (double)prof_entries[p], (total != 0) ? (100.0 * (double)value / (double)total) : 0.0);
+    for (uint8_t c = PROF_CYCLES + 1; c < NUM_PROF_COUNTERS; c++)
+    {
+      if (prof_available[c])
+        printf(" %13llu |", (unsigned long long)phase_count((cmprss_phase_t)p, (cmprss_counter_t)c));
+      else
+        printf(" %13s |", "n/a");
+    }
+    if (prof_available[PROF_INSTRUCTIONS] && (value != 0))
+      printf(" %5.2f |\n", (double)phase_count((cmprss_phase_t)p, PROF_INSTRUCTIONS) / (double)value);
+    else
+      printf(" %5s |\n", "n/a");
+  }
+}
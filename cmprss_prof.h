@@ -0,0 +1,49 @@
+#ifndef CMPRSS_PROF_H
+#define CMPRSS_PROF_H
+#include <stdint.h>
+
+#include "compression_test.h"
+
+typedef enum
+{
+  PROF_IDLE = 0,      // outside the codec, not reported
+  PROF_ESTIMATE,      // predictor and estimate_array_size, deciding whether to compress at all
+  PROF_TOKENIZE,      // byte_compress token logic, everything which is not a bulk move
+  PROF_SHIFT,         // byte_compress memmove/memset shifting the array in place
+  PROF_DECODE_SCAN,   // byte_decompress token walk and search for the next token
+  PROF_DECODE_FILL,   // byte_decompress memset of matched runs
+  PROF_DECODE_COPY,   // byte_decompress memmove of unmatched literals
+  NUM_PROF_PHASES
+} cmprss_phase_t;
+
+typedef enum
+{
+  PROF_CYCLES = 0, // tsc ticks when the hardware counters are not available
+  PROF_INSTRUCTIONS,
+  PROF_BRANCH_MISSES,
+  PROF_L1D_MISSES,
+  NUM_PROF_COUNTERS
+} cmprss_counter_t;
+
+// the codec calls these at every phase change, they compile to nothing unless PROFILE_PHASES is 1
+#if PROFILE_PHASES == 1
+#define PROF_PHASE(phase) cmprss_prof_switch(phase)
+#else
+#define PROF_PHASE(phase) ((void)0)
+#endif
+#define PROF_STOP() PROF_PHASE(PROF_IDLE)
+// runs one statement under phase, then goes back to phase back
+#define PROF_SCOPE(phase, back, statement) \
+  do                                       \
+  {                                        \
+    PROF_PHASE(phase);                     \
+    statement;                             \
+    PROF_PHASE(back);                      \
+  } while (0)
+
+void cmprss_prof_init(void);
+void cmprss_prof_reset(void);
+void cmprss_prof_switch(cmprss_phase_t phase);
+void cmprss_prof_print(const char *title);
+
+#endif //CMPRSS_PROF_H
@@ -0,0 +1,53 @@
+/**
+ * @file cmprss_test_data.c
+ * @brief repeatable generated input for the self tests and the benchmarks
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * Everything here is seeded, so a failing self test can be reproduced from the seed and size it prints.
+ */
+#include "cmprss_test_data.h"
+
+/**
+ * @brief xorshift32, repeatable between runs and platforms unlike rand()
+ *
+ * @param state must not be 0
+ * @return uint32_t
+ */
+uint32_t cmprss_test_rand(uint32_t *state)
+{
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x;
+}
+
+/**
+ * @brief fills the array with runs of random values and random length
+ *
+ * @param data_ptr
+ * @param data_size
+ * @param seed any value, 0 included
+ * @param value_mask e.g. MAX_NON_TOKEN_DATA for byte_compress input
+ * @param max_hold longest run, 1 gives no runs at all
+ */
+void cmprss_test_fill_runs(buffer_element_t *data_ptr, array_size_t data_size, uint32_t seed, buffer_element_t value_mask, uint32_t max_hold)
+{
+  uint32_t state = (seed * 2654435761u) | 1;
+  buffer_element_t value = 0;
+  array_size_t hold = 0;
+
+  for (array_size_t k = 0; k < data_size; k++)
+  {
+    if (hold == 0)
+    {
+      cmprss_test_rand(&state);
+      value = (buffer_element_t)(state & value_mask);
+      hold = 1 + ((state >> 8) % max_hold);
+    }
+    data_ptr[k] = value;
+    hold--;
+  }
+}
@@ -0,0 +1,14 @@
+#ifndef CMPRSS_TEST_DATA_H
+#define CMPRSS_TEST_DATA_H
+#include <stdint.h>
+
+#include "compression_test.h"
+
+// the self tests run every size up to MAX_INPUT_SIZE once per seed, with the size mixed into the seed
+#define SELF_TEST_SEEDS 8
+#define SELF_TEST_SEED(seed, size) ((seed) + (uint32_t)((size) << 8))
+
+uint32_t cmprss_test_rand(uint32_t *state);
+void cmprss_test_fill_runs(buffer_element_t *data_ptr, array_size_t data_size, uint32_t seed, buffer_element_t value_mask, uint32_t max_hold);
+
+#endif //CMPRSS_TEST_DATA_H
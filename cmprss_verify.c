@@ -0,0 +1,783 @@
+/**
+ * @file cmprss_verify.c
+ * @brief large scale round trip verification, byte_decompress(byte_compress(x)) == x over millions of inputs
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * Inputs are numbered and generated from their index, so any input can be regenerated from the report. The first
+ * inputs enumerate every run boundary pattern up to VERIFY_EXHAUSTIVE_MAX_SIZE bytes, the rest alternate between
+ * generated run length data (sizes up to MAX_INPUT_SIZE, runs around the NIBBLE_VALUE_MASK cap) and mutations
+ * of the regression arrays.
+ *
+ * The index range is split across one worker process per core. Each worker pops inputs from the front of its own
+ * range and, once that is empty, steals the back half of the fullest range left. Workers are processes rather than
+ * threads because byte_compress can still crash on some inputs: the parent pins the crash on the input the worker
+ * had in hand, restarts the worker and it carries on with its range. The hang alarm is armed for every input and
+ * only ends the worker while that input runs, so a kill never lands while a worker moves an input or a stolen half
+ * between slots. Failing inputs are then shrunk to minimal ones, each candidate checked in its own process for the
+ * same reason.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "cmprss_verify.h"
+#include "benchmark.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define VERIFY_HAVE_FORK 1
+#include <unistd.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#endif
+
+#define VERIFY_CACHE_LINE 64
+#define NUM_SIZE_CLASSES 4
+// per input timing histogram, 4 buckets per power of 2 so percentiles are within 25%
+#define VERIFY_HIST_SUB_BITS 2
+#define VERIFY_HIST_BUCKETS (40 << VERIFY_HIST_SUB_BITS)
+
+// isolated checks exit with this plus their result, so an exit() from somewhere else (e.g. a sanitizer) is not
+// mistaken for one
+#define VERIFY_EXIT_BASE 100
+
+// a range is packed as next << 32 | end so the owner and the thieves can both move it with one compare and swap
+#define RANGE_PACK(next, end) (((uint64_t)(next) << 32) | (uint64_t)(end))
+#define RANGE_NEXT(range) ((range) >> 32)
+#define RANGE_END(range) ((range) & 0xFFFFFFFFull)
+
+static const array_size_t size_class_max[NUM_SIZE_CLASSES] = {16, 64, 128, MAX_INPUT_SIZE};
+static const char *const result_names[NUM_VERIFY_RESULTS] = {"pass", "stored", "mismatch", "wrong size", "crash", "hang"};
+
+typedef struct
+{
+  _Alignas(VERIFY_CACHE_LINE) _Atomic uint64_t range;
+  _Atomic uint64_t current; // input in hand, so a crash can be pinned on it
+  // everything below is only written by the worker, and by the parent once the worker is dead
+  _Alignas(VERIFY_CACHE_LINE) uint64_t results[NUM_VERIFY_RESULTS];
+  uint64_t steals;
+  uint64_t restarts;
+  uint64_t bytes[NUM_SIZE_CLASSES];
+  uint64_t total_ns[NUM_SIZE_CLASSES];
+  uint64_t slowest_ns[NUM_SIZE_CLASSES];
+  uint64_t slowest_index[NUM_SIZE_CLASSES];
+  uint32_t hist[NUM_SIZE_CLASSES][VERIFY_HIST_BUCKETS];
+} verify_worker_t;
+
+typedef struct
+{
+  verify_worker_t workers[VERIFY_MAX_WORKERS];
+  _Atomic uint32_t kept[NUM_VERIFY_RESULTS];
+  uint64_t failures[NUM_VERIFY_RESULTS][VERIFY_KEEP_FAILURES];
+} verify_shared_t;
+
+static uint8_t size_class(array_size_t data_size)
+{
+  uint8_t c = 0;
+
+  while ((c < (NUM_SIZE_CLASSES - 1)) && (data_size > size_class_max[c]))
+    c++;
+
+  return c;
+}
+
+static uint32_t hist_bucket(uint64_t ns)
+{
+  uint32_t msb = 0, bucket = 0;
+
+  if (ns < (1u << VERIFY_HIST_SUB_BITS))
+    return (uint32_t)ns;
+
+  msb = 63 - (uint32_t)__builtin_clzll(ns);
+  bucket = ((msb - VERIFY_HIST_SUB_BITS + 1) << VERIFY_HIST_SUB_BITS) +
+           (uint32_t)((ns >> (msb - VERIFY_HIST_SUB_BITS)) & ((1u << VERIFY_HIST_SUB_BITS) - 1));
+
+  return (bucket < VERIFY_HIST_BUCKETS) ? bucket : (VERIFY_HIST_BUCKETS - 1);
+}
+
+static uint64_t hist_bucket_ns(uint32_t bucket)
+{
+  uint32_t octave = bucket >> VERIFY_HIST_SUB_BITS;
+
+  if (octave == 0)
+    return bucket;
+
+  return (uint64_t)((1u << VERIFY_HIST_SUB_BITS) | (bucket & ((1u << VERIFY_HIST_SUB_BITS) - 1))) << (octave - 1);
+}
+
+/**
+ * @brief runs of distinct values, run_starts bit k set means byte k + 1 starts a new run. Neighbouring runs
+ * always differ so the pattern is exactly the one byte_compress sees.
+ *
+ * @param data_ptr
+ * @param data_size
+ * @param run_starts
+ * @param first_value
+ */
+static void fill_boundaries(buffer_element_t *data_ptr, array_size_t data_size, uint64_t run_starts, buffer_element_t first_value)
+{
+  buffer_element_t value = first_value;
+
+  for (array_size_t k = 0; k < data_size; k++)
+  {
+    if ((k != 0) && ((run_starts >> (k - 1)) & 1))
+      value = (buffer_element_t)((value + 1 + (k % 3)) & MAX_NON_TOKEN_DATA);
+    data_ptr[k] = value;
+  }
+}
+
+/**
+ * @brief a run length, mostly around the mean but often right on the NIBBLE_VALUE_MASK boundaries where the
+ * token layout changes
+ *
+ * @param state
+ * @param mean
+ * @return array_size_t
+ */
+static array_size_t run_length(uint32_t *state, uint32_t mean)
+{
+  static const array_size_t edges[] = {NIBBLE_VALUE_MASK - 1, NIBBLE_VALUE_MASK, NIBBLE_VALUE_MASK + 1,
+                                       (2 * NIBBLE_VALUE_MASK), (2 * NIBBLE_VALUE_MASK) + 1, (2 * NIBBLE_VALUE_MASK) + 2};
+
+  if ((benchmark_rand(state) & 3) == 0)
+    return edges[benchmark_rand(state) % (sizeof(edges) / sizeof(edges[0]))];
+
+  return 1 + (benchmark_rand(state) % ((2 * mean) - 1));
+}
+
+/**
+ * @brief generated run length data, any size up to MAX_INPUT_SIZE
+ *
+ * @param state
+ * @param data_ptr
+ * @return array_size_t size
+ */
+static array_size_t generate_runs(uint32_t *state, buffer_element_t *data_ptr)
+{
+  static const uint32_t means[] = {1, 2, 3, 5, 8, 16, 48};
+  static const buffer_element_t edge_values[] = {0x00, 0x01, MAX_NON_TOKEN_DATA - 1, MAX_NON_TOKEN_DATA};
+  uint8_t c = (uint8_t)(benchmark_rand(state) % NUM_SIZE_CLASSES);
+  array_size_t low = (c == 0) ? 1 : (size_class_max[c - 1] + 1);
+  array_size_t data_size = low + (benchmark_rand(state) % (size_class_max[c] - low + 1));
+  uint32_t mean = means[benchmark_rand(state) % (sizeof(means) / sizeof(means[0]))];
+  uint8_t edges_only = ((benchmark_rand(state) & 3) == 0);
+  buffer_element_t value = ERASED_BYTE, next = 0;
+  array_size_t k = 0, run = 0;
+
+  while (k < data_size)
+  {
+    do
+    {
+      next = edges_only ? edge_values[benchmark_rand(state) % (sizeof(edge_values) / sizeof(edge_values[0]))]
+                        : (buffer_element_t)(benchmark_rand(state) & MAX_NON_TOKEN_DATA);
+    } while (next == value);
+    value = next;
+
+    for (run = run_length(state, mean); (run != 0) && (k < data_size); run--)
+      data_ptr[k++] = value;
+  }
+
+  return data_size;
+}
+
+/**
+ * @brief one of the seed arrays or a generated input, with a few edits on top
+ *
+ * @param state
+ * @param data_ptr
+ * @param seeds
+ * @param seed_sizes
+ * @param num_seeds
+ * @return array_size_t size
+ */
+static array_size_t generate_mutation(uint32_t *state, buffer_element_t *data_ptr, buffer_element_t (*seeds)[MAX_INPUT_SIZE],
+                                      const array_size_t *seed_sizes, uint8_t num_seeds)
+{
+  array_size_t data_size = 0, pos = 0, len = 0;
+  uint8_t seed = 0, edits = 1 + (uint8_t)(benchmark_rand(state) % 4);
+
+  if (benchmark_rand(state) & 1)
+  {
+    seed = (uint8_t)(benchmark_rand(state) % num_seeds);
+    data_size = seed_sizes[seed];
+    memcpy(data_ptr, seeds[seed], data_size);
+  }
+  else
+  {
+    data_size = generate_runs(state, data_ptr);
+  }
+
+  while (edits-- != 0)
+  {
+    pos = benchmark_rand(state) % data_size;
+    switch (benchmark_rand(state) % 6)
+    {
+      case 0: // new value
+        data_ptr[pos] = (buffer_element_t)(benchmark_rand(state) & MAX_NON_TOKEN_DATA);
+        break;
+      case 1: // join the neighbouring runs
+        if (pos != 0)
+          data_ptr[pos] = data_ptr[pos - 1];
+        break;
+      case 2: // grow a run by one
+        if (data_size < MAX_INPUT_SIZE)
+        {
+          memmove(&data_ptr[pos + 1], &data_ptr[pos], data_size - pos);
+          data_size++;
+        }
+        break;
+      case 3: // drop a byte
+        if (data_size > 1)
+        {
+          memmove(&data_ptr[pos], &data_ptr[pos + 1], data_size - pos - 1);
+          data_size--;
+        }
+        break;
+      case 4: // splice in a run
+        len = run_length(state, NIBBLE_VALUE_MASK);
+        if ((data_size + len) > MAX_INPUT_SIZE)
+          len = MAX_INPUT_SIZE - data_size;
+        memmove(&data_ptr[pos + len], &data_ptr[pos], data_size - pos);
+        memset(&data_ptr[pos], benchmark_rand(state) & MAX_NON_TOKEN_DATA, len);
+        data_size += len;
+        break;
+      default: // cut short
+        data_size = pos + 1;
+        break;
+    }
+  }
+
+  return data_size;
+}
+
+/**
+ * @brief regenerates input number index
+ *
+ * @param index
+ * @param data_ptr room for MAX_INPUT_SIZE bytes
+ * @param seeds arrays to mutate, e.g. the regression test arrays
+ * @param seed_sizes
+ * @param num_seeds
+ * @return array_size_t size of the input
+ */
+array_size_t cmprss_verify_generate(uint64_t index, buffer_element_t *data_ptr, buffer_element_t (*seeds)[MAX_INPUT_SIZE],
+                                    const array_size_t *seed_sizes, uint8_t num_seeds)
+{
+  const uint64_t exhaustive = (1ull << VERIFY_EXHAUSTIVE_MAX_SIZE) - 1;
+  array_size_t data_size = 0;
+  uint32_t state = 0;
+
+  if (index < exhaustive)
+  {
+    // sizes 1, 2, 3... each followed by all of its 2^(size-1) run boundary patterns
+    data_size = 64 - (array_size_t)__builtin_clzll(index + 1);
+    fill_boundaries(data_ptr, data_size, (index + 1) - (1ull << (data_size - 1)), (buffer_element_t)(index % (MAX_NON_TOKEN_DATA + 1)));
+    return data_size;
+  }
+
+  index -= exhaustive;
+  state = (uint32_t)((index * 2654435761u) ^ (index >> 32)) | 1;
+  benchmark_rand(&state);
+
+  if (((index & 3) < 2) || (num_seeds == 0))
+    return generate_runs(&state, data_ptr);
+
+  return generate_mutation(&state, data_ptr, seeds, seed_sizes, num_seeds);
+}
+
+/**
+ * @brief one round trip, with the same stored convention as regression_test
+ *
+ * @param input_ptr
+ * @param input_size
+ * @return verify_result_t
+ */
+verify_result_t cmprss_verify_case(const buffer_element_t *input_ptr, array_size_t input_size)
+{
+  buffer_element_t cmprss[MAX_INPUT_SIZE + VERIFY_PAD];
+  buffer_element_t decmprss[MAX_INPUT_SIZE + VERIFY_PAD];
+  int cmprss_size = 0, decmprss_size = 0;
+
+  memset(cmprss, ERASED_BYTE, sizeof(cmprss));
+  memcpy(cmprss, input_ptr, input_size);
+  cmprss_size = byte_compress(cmprss, input_size);
+
+  if ((cmprss_size < 0) || ((array_size_t)cmprss_size >= input_size))
+    return VERIFY_STORED;
+
+  // inputs never hold ERASED_BYTE, so nothing left unwritten can pass for the input
+  memset(decmprss, ERASED_BYTE, sizeof(decmprss));
+  decmprss_size = byte_decompress(decmprss, MAX_INPUT_SIZE, cmprss, (array_size_t)cmprss_size);
+
+  if (memcmp(decmprss, input_ptr, input_size) != 0)
+    return VERIFY_MISMATCH;
+  if ((array_size_t)decmprss_size != input_size)
+    return VERIFY_WRONG_SIZE;
+
+  return VERIFY_PASS;
+}
+
+#ifdef VERIFY_HAVE_FORK
+
+static uint64_t env_count(const char *name, uint64_t fallback, uint64_t max)
+{
+  const char *value = getenv(name);
+  uint64_t count = 0;
+
+  if ((value == NULL) || (value[0] == '\0'))
+    return fallback;
+
+  count = strtoull(value, NULL, 10);
+  if ((count == 0) || (count > max))
+  {
+    printf("%s=%s is out of range, using %llu\n", name, value, (unsigned long long)fallback);
+    return fallback;
+  }
+
+  return count;
+}
+
+static void keep_failure(verify_shared_t *shared, verify_result_t result, uint64_t index)
+{
+  uint32_t slot = atomic_fetch_add_explicit(&shared->kept[result], 1, memory_order_relaxed);
+
+  if (slot < VERIFY_KEEP_FAILURES)
+    shared->failures[result][slot] = index;
+}
+
+/**
+ * @brief takes the next input off the front of the worker's own range
+ *
+ * @param range
+ * @param index_ptr
+ * @return uint8_t 0 once the range is empty
+ */
+static uint8_t pop_index(_Atomic uint64_t *range, uint64_t *index_ptr)
+{
+  uint64_t current = atomic_load_explicit(range, memory_order_acquire);
+
+  while (RANGE_NEXT(current) < RANGE_END(current))
+  {
+    if (atomic_compare_exchange_weak_explicit(range, &current, current + (1ull << 32), memory_order_acq_rel, memory_order_acquire))
+    {
+      *index_ptr = RANGE_NEXT(current);
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief moves the back half of the fullest range into the worker's own, which must be empty
+ *
+ * @param shared
+ * @param self
+ * @param num_workers
+ * @return uint8_t 0 once every range is empty
+ */
+static uint8_t steal_range(verify_shared_t *shared, uint8_t self, uint8_t num_workers)
+{
+  uint64_t current = 0, left = 0, most = 0, next = 0, end = 0, mid = 0;
+  uint8_t victim = 0;
+
+  for (;;)
+  {
+    most = 0;
+    for (uint8_t k = 0; k < num_workers; k++)
+    {
+      current = atomic_load_explicit(&shared->workers[k].range, memory_order_relaxed);
+      left = (RANGE_NEXT(current) < RANGE_END(current)) ? (RANGE_END(current) - RANGE_NEXT(current)) : 0;
+      if ((k != self) && (left > most))
+      {
+        most = left;
+        victim = k;
+      }
+    }
+    if (most == 0)
+      return 0;
+
+    current = atomic_load_explicit(&shared->workers[victim].range, memory_order_acquire);
+    next = RANGE_NEXT(current);
+    end = RANGE_END(current);
+    if (next >= end)
+      continue;
+
+    // a single input left goes to the thief whole
+    mid = next + ((end - next) / 2);
+    if (atomic_compare_exchange_strong_explicit(&shared->workers[victim].range, &current, RANGE_PACK(next, mid),
+                                                memory_order_acq_rel, memory_order_acquire))
+    {
+      atomic_store_explicit(&shared->workers[self].range, RANGE_PACK(mid, end), memory_order_release);
+      shared->workers[self].steals++;
+      return 1;
+    }
+  }
+}
+
+// set while a worker books a result and moves an input or a stolen range between slots, see on_alarm
+static volatile sig_atomic_t between_cases = 0, alarm_deferred = 0;
+
+/**
+ * @brief the worker's hang alarm. Between cases a worker killed after the steal's compare and swap but before the
+ * store into its own slot, or between a pop and publishing current, would drop those inputs, and one killed while
+ * it books a result would get the input booked twice. There the alarm is only noted, the input which ran out of
+ * time has finished after all. While a case runs it ends the worker as the default action would
+ *
+ * @param sig
+ */
+static void on_alarm(int sig)
+{
+  if (between_cases)
+  {
+    alarm_deferred = 1;
+    return;
+  }
+  signal(sig, SIG_DFL);
+  raise(sig);
+}
+
+static void worker_main(verify_shared_t *shared, uint8_t self, uint8_t num_workers, buffer_element_t (*seeds)[MAX_INPUT_SIZE],
+                        const array_size_t *seed_sizes, uint8_t num_seeds)
+{
+  verify_worker_t *worker = &shared->workers[self];
+  buffer_element_t input[MAX_INPUT_SIZE + VERIFY_PAD];
+  verify_result_t result = VERIFY_PASS;
+  array_size_t input_size = 0;
+  uint64_t index = 0, t0 = 0, ns = 0;
+  uint8_t c = 0;
+
+  between_cases = 1;
+  signal(SIGALRM, on_alarm);
+  for (;;)
+  {
+    if (!pop_index(&worker->range, &index) && !(steal_range(shared, self, num_workers) && pop_index(&worker->range, &index)))
+      break;
+    atomic_store_explicit(&worker->current, index, memory_order_relaxed);
+
+    // every input gets the whole timeout, an alarm noted since the last one was not a hang
+    alarm(VERIFY_CASE_TIMEOUT_S);
+    alarm_deferred = 0;
+    atomic_signal_fence(memory_order_seq_cst);
+    between_cases = 0;
+    atomic_signal_fence(memory_order_seq_cst);
+
+    memset(input, ERASED_BYTE, sizeof(input));
+    input_size = cmprss_verify_generate(index, input, seeds, seed_sizes, num_seeds);
+
+    t0 = benchmark_now_ns();
+    result = cmprss_verify_case(input, input_size);
+    ns = benchmark_now_ns() - t0;
+
+    atomic_signal_fence(memory_order_seq_cst);
+    between_cases = 1;
+    atomic_signal_fence(memory_order_seq_cst);
+
+    worker->results[result]++;
+    if (result > VERIFY_STORED)
+      keep_failure(shared, result, index);
+
+    c = size_class(input_size);
+    worker->bytes[c] += input_size;
+    worker->total_ns[c] += ns;
+    worker->hist[c][hist_bucket(ns)]++;
+    if (ns > worker->slowest_ns[c])
+    {
+      worker->slowest_ns[c] = ns;
+      worker->slowest_index[c] = index;
+    }
+  }
+
+  alarm(0);
+}
+
+static pid_t spawn_worker(verify_shared_t *shared, uint8_t self, uint8_t num_workers, buffer_element_t (*seeds)[MAX_INPUT_SIZE],
+                          const array_size_t *seed_sizes, uint8_t num_seeds)
+{
+  pid_t pid = 0;
+
+  // anything still buffered would be printed again by the child
+  fflush(stdout);
+  pid = fork();
+  if (pid == 0)
+  {
+    worker_main(shared, self, num_workers, seeds, seed_sizes, num_seeds);
+    _exit(0);
+  }
+
+  return pid;
+}
+
+/**
+ * @brief cmprss_verify_case in a child process, so a crash or hang is a result instead of the end of the run
+ *
+ * @param input_ptr
+ * @param input_size
+ * @return verify_result_t
+ */
+static verify_result_t verify_case_isolated(const buffer_element_t *input_ptr, array_size_t input_size)
+{
+  buffer_element_t input[MAX_INPUT_SIZE + VERIFY_PAD];
+  pid_t pid = 0;
+  int status = 0;
+
+  memset(input, ERASED_BYTE, sizeof(input));
+  memcpy(input, input_ptr, input_size);
+
+  fflush(stdout);
+  pid = fork();
+  if (pid == 0)
+  {
+    alarm(VERIFY_CASE_TIMEOUT_S);
+    _exit(VERIFY_EXIT_BASE + (int)cmprss_verify_case(input, input_size));
+  }
+  if ((pid < 0) || (waitpid(pid, &status, 0) != pid))
+    return VERIFY_PASS;
+
+  if (WIFEXITED(status) && (WEXITSTATUS(status) >= VERIFY_EXIT_BASE) && (WEXITSTATUS(status) < (VERIFY_EXIT_BASE + NUM_VERIFY_RESULTS)))
+    return (verify_result_t)(WEXITSTATUS(status) - VERIFY_EXIT_BASE);
+  if (WIFSIGNALED(status) && (WTERMSIG(status) == SIGALRM))
+    return VERIFY_HANG;
+
+  return VERIFY_CRASH;
+}
+
+/**
+ * @brief shrinks a failing input while it keeps failing the same way: drops chunks, halving the chunk size when
+ * none can go, then renumbers the values 0, 1, 2... in order of first appearance
+ *
+ * @param data_ptr shrunk in place
+ * @param data_size
+ * @param result the failure to keep
+ * @return array_size_t shrunk size
+ */
+static array_size_t shrink_input(buffer_element_t *data_ptr, array_size_t data_size, verify_result_t result)
+{
+  buffer_element_t candidate[MAX_INPUT_SIZE];
+  int16_t relabel[MAX_NON_TOKEN_DATA + 1];
+  array_size_t chunk = data_size / 2, start = 0;
+  int16_t next_label = 0;
+
+  while ((chunk != 0) && (data_size > 1))
+  {
+    uint8_t removed = 0;
+
+    for (start = 0; ((start + chunk) <= data_size) && (chunk < data_size);)
+    {
+      memcpy(candidate, data_ptr, start);
+      memcpy(&candidate[start], &data_ptr[start + chunk], data_size - start - chunk);
+      if (verify_case_isolated(candidate, data_size - chunk) == result)
+      {
+        data_size -= chunk;
+        memcpy(data_ptr, candidate, data_size);
+        removed = 1;
+      }
+      else
+      {
+        start += chunk;
+      }
+    }
+
+    if (!removed)
+      chunk /= 2;
+    else if (chunk > (data_size / 2))
+      chunk = data_size / 2;
+  }
+
+  memset(relabel, -1, sizeof(relabel));
+  for (array_size_t k = 0; k < data_size; k++)
+  {
+    if (relabel[data_ptr[k] & MAX_NON_TOKEN_DATA] < 0)
+      relabel[data_ptr[k] & MAX_NON_TOKEN_DATA] = next_label++;
+    candidate[k] = (buffer_element_t)relabel[data_ptr[k] & MAX_NON_TOKEN_DATA];
+  }
+  if (verify_case_isolated(candidate, data_size) == result)
+    memcpy(data_ptr, candidate, data_size);
+
+  return data_size;
+}
+
+static void print_timing(verify_shared_t *shared, uint8_t num_workers)
+{
+  static const uint32_t permille[] = {500, 990, 999};
+  uint64_t count = 0, bytes = 0, total_ns = 0, slowest_ns = 0, slowest_index = 0, seen = 0;
+  uint64_t at[sizeof(permille) / sizeof(permille[0])];
+  uint32_t bucket_count = 0;
+  uint8_t p = 0;
+
+  printf("\n| input size | %9s | %7s | %8s | %8s | %8s | %8s | %13s |\n", "inputs", "MB/s", "p50 ns", "p99 ns", "p99.9 ns", "max ns", "slowest input");
+  printf("|------------|-----------|---------|----------|----------|----------|----------|---------------|\n");
+  for (uint8_t c = 0; c < NUM_SIZE_CLASSES; c++)
+  {
+    count = bytes = total_ns = slowest_ns = slowest_index = seen = 0;
+    for (uint8_t w = 0; w < num_workers; w++)
+    {
+      verify_worker_t *worker = &shared->workers[w];
+      bytes += worker->bytes[c];
+      total_ns += worker->total_ns[c];
+      for (uint32_t b = 0; b < VERIFY_HIST_BUCKETS; b++)
+        count += worker->hist[c][b];
+      if (worker->slowest_ns[c] > slowest_ns)
+      {
+        slowest_ns = worker->slowest_ns[c];
+        slowest_index = worker->slowest_index[c];
+      }
+    }
+    if (count == 0)
+      continue;
+
+    // walk the merged histogram once, picking up each percentile as it is passed
+    memset(at, 0, sizeof(at));
+    p = 0;
+    for (uint32_t b = 0; (b < VERIFY_HIST_BUCKETS) && (p < (sizeof(permille) / sizeof(permille[0]))); b++)
+    {
+      bucket_count = 0;
+      for (uint8_t w = 0; w < num_workers; w++)
+        bucket_count += shared->workers[w].hist[c][b];
+      seen += bucket_count;
+      while ((p < (sizeof(permille) / sizeof(permille[0]))) && ((seen * 1000) >= (count * permille[p])))
+        at[p++] = hist_bucket_ns(b);
+    }
+
+    printf("| %4llu..%-4llu | %9llu | %7.1f | %8llu | %8llu | %8llu | %8llu | %13llu |\n",
+           (unsigned long long)((c == 0) ? 1 : (size_class_max[c - 1] + 1)), (unsigned long long)size_class_max[c],
+           (unsigned long long)count, (double)bytes * 1000.0 / (double)(total_ns + 1),
+           (unsigned long long)at[0], (unsigned long long)at[1], (unsigned long long)at[2],
+           (unsigned long long)slowest_ns, (unsigned long long)slowest_index);
+  }
+}
+
+/**
+ * @brief checks VERIFY_NUM_INPUTS generated and mutated inputs on every core, then prints a results table, per
+ * input timing and each kept failure shrunk to a minimal input
+ *
+ * @param seeds arrays to mutate, e.g. the regression test arrays
+ * @param seed_sizes
+ * @param num_seeds
+ * @return uint8_t 1 if every input round tripped
+ */
+uint8_t cmprss_verify_run(buffer_element_t (*seeds)[MAX_INPUT_SIZE], const array_size_t *seed_sizes, uint8_t num_seeds)
+{
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  uint64_t num_inputs = env_count(VERIFY_INPUTS_ENV, VERIFY_NUM_INPUTS, 0xFFFFFFFFull);
+  uint8_t num_workers = (uint8_t)env_count(VERIFY_WORKERS_ENV, (cores < 1) ? 1 : ((cores > VERIFY_MAX_WORKERS) ? VERIFY_MAX_WORKERS : (uint64_t)cores), VERIFY_MAX_WORKERS);
+  pid_t pids[VERIFY_MAX_WORKERS];
+  uint64_t totals[NUM_VERIFY_RESULTS];
+  uint64_t steals = 0, restarts = 0, failures = 0, checked = 0, t0 = 0, index = 0;
+  buffer_element_t input[MAX_INPUT_SIZE + VERIFY_PAD];
+  array_size_t input_size = 0, shrunk_size = 0;
+  verify_result_t result = VERIFY_PASS;
+  verify_shared_t *shared = NULL;
+  uint8_t alive = 0, w = 0;
+  pid_t pid = 0;
+  int status = 0;
+
+  shared = mmap(NULL, sizeof(*shared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (shared == MAP_FAILED)
+  {
+    printf("verification: could not map the shared state\n");
+    return 0;
+  }
+  memset(shared, 0, sizeof(*shared));
+
+  t0 = benchmark_now_ns();
+  for (w = 0; w < num_workers; w++)
+  {
+    atomic_store(&shared->workers[w].range, RANGE_PACK((num_inputs * w) / num_workers, (num_inputs * (w + 1)) / num_workers));
+    pids[w] = spawn_worker(shared, w, num_workers, seeds, seed_sizes, num_seeds);
+    if (pids[w] > 0)
+      alive++;
+  }
+
+  while (alive != 0)
+  {
+    pid = wait(&status);
+    if (pid < 0)
+      break;
+    for (w = 0; (w < num_workers) && (pids[w] != pid); w++)
+      ;
+    if (w == num_workers)
+      continue;
+
+    if (WIFEXITED(status) && (WEXITSTATUS(status) == 0))
+    {
+      pids[w] = 0;
+      alive--;
+      continue;
+    }
+
+    // the worker died on the input it had in hand, that input is already off its range so the restart moves on
+    result = (WIFSIGNALED(status) && (WTERMSIG(status) == SIGALRM)) ? VERIFY_HANG : VERIFY_CRASH;
+    index = atomic_load(&shared->workers[w].current);
+    shared->workers[w].results[result]++;
+    shared->workers[w].restarts++;
+    keep_failure(shared, result, index);
+
+    pids[w] = spawn_worker(shared, w, num_workers, seeds, seed_sizes, num_seeds);
+    if (pids[w] <= 0)
+      alive--;
+  }
+  t0 = benchmark_now_ns() - t0;
+
+  memset(totals, 0, sizeof(totals));
+  for (w = 0; w < num_workers; w++)
+  {
+    for (uint8_t r = 0; r < NUM_VERIFY_RESULTS; r++)
+      totals[r] += shared->workers[w].results[r];
+    steals += shared->workers[w].steals;
+    restarts += shared->workers[w].restarts;
+  }
+
+  printf("\n### Round trip verification, %llu inputs on %u workers\n", (unsigned long long)num_inputs, num_workers);
+  printf("%.1f s, %.0f inputs/s, %llu steals, %llu worker restarts\n\n", (double)t0 / 1e9, (double)num_inputs * 1e9 / (double)(t0 + 1),
+         (unsigned long long)steals, (unsigned long long)restarts);
+  printf("| %-10s | %9s | %6s |\n", "result", "inputs", "%");
+  printf("|------------|-----------|--------|\n");
+  for (uint8_t r = 0; r < NUM_VERIFY_RESULTS; r++)
+  {
+    printf("| %-10s | %9llu | %6.2f |\n", result_names[r], (unsigned long long)totals[r], 100.0 * (double)totals[r] / (double)num_inputs);
+    if (r > VERIFY_STORED)
+      failures += totals[r];
+    checked += totals[r];
+  }
+  // only a worker killed from outside can still drop a range, say so rather than report a short run as clean
+  if (checked < num_inputs)
+  {
+    printf("\n%llu of the inputs never ran\n", (unsigned long long)(num_inputs - checked));
+    failures++;
+  }
+
+  print_timing(shared, num_workers);
+
+  for (uint8_t r = VERIFY_STORED + 1; r < NUM_VERIFY_RESULTS; r++)
+  {
+    for (uint32_t k = 0; (k < shared->kept[r]) && (k < VERIFY_KEEP_FAILURES); k++)
+    {
+      memset(input, ERASED_BYTE, sizeof(input));
+      input_size = cmprss_verify_generate(shared->failures[r][k], input, seeds, seed_sizes, num_seeds);
+      shrunk_size = shrink_input(input, input_size, (verify_result_t)r);
+      printf("\n%s: input %llu, %llu bytes, shrinks to %llu bytes\n", result_names[r], (unsigned long long)shared->failures[r][k],
+             (unsigned long long)input_size, (unsigned long long)shrunk_size);
+      print_array(input, shrunk_size);
+    }
+  }
+
+  munmap(shared, sizeof(*shared));
+
+  return failures == 0;
+}
+
+#else
+
+uint8_t cmprss_verify_run(buffer_element_t (*seeds)[MAX_INPUT_SIZE], const array_size_t *seed_sizes, uint8_t num_seeds)
+{
+  (void)seeds;
+  (void)seed_sizes;
+  (void)num_seeds;
+  printf("verification needs fork() to survive codec crashes, not available on this platform, skipped\n");
+  return 1;
+}
+
+#endif // VERIFY_HAVE_FORK
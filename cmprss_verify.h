@@ -0,0 +1,39 @@
+#ifndef CMPRSS_VERIFY_H
+#define CMPRSS_VERIFY_H
+#include <stdint.h>
+
+#include "compression_test.h"
+
+// inputs checked by cmprss_verify_run, override with CMPRSS_VERIFY_INPUTS=<count>
+#define VERIFY_NUM_INPUTS 2000000
+#define VERIFY_INPUTS_ENV "CMPRSS_VERIFY_INPUTS"
+// worker processes, defaults to one per online core, override with CMPRSS_VERIFY_WORKERS=<count>
+#define VERIFY_WORKERS_ENV "CMPRSS_VERIFY_WORKERS"
+#define VERIFY_MAX_WORKERS 64
+// every run boundary pattern is checked exhaustively for inputs up to this size, 2^(size-1) patterns per size
+#define VERIFY_EXHAUSTIVE_MAX_SIZE 16
+// failing inputs kept for shrinking, per failure kind
+#define VERIFY_KEEP_FAILURES 4
+// an input which has not finished after this long counts as a hang
+#define VERIFY_CASE_TIMEOUT_S 5
+// getMatchLen reads past the end of the input and byte_decompress only checks its output once per token,
+// keep both inside the buffers
+#define VERIFY_PAD 64
+
+typedef enum
+{
+  VERIFY_PASS = 0,   // decompressed back to the input
+  VERIFY_STORED,     // byte_compress declined, the input goes out stored, same as regression_test
+  VERIFY_MISMATCH,   // decompressed, but not to the input
+  VERIFY_WRONG_SIZE, // decompressed to the input, but byte_decompress reported another size
+  VERIFY_CRASH,      // the process died inside the codec
+  VERIFY_HANG,       // did not finish inside VERIFY_CASE_TIMEOUT_S
+  NUM_VERIFY_RESULTS
+} verify_result_t;
+
+array_size_t cmprss_verify_generate(uint64_t index, buffer_element_t *data_ptr, buffer_element_t (*seeds)[MAX_INPUT_SIZE],
+                                    const array_size_t *seed_sizes, uint8_t num_seeds);
+verify_result_t cmprss_verify_case(const buffer_element_t *input_ptr, array_size_t input_size);
+uint8_t cmprss_verify_run(buffer_element_t (*seeds)[MAX_INPUT_SIZE], const array_size_t *seed_sizes, uint8_t num_seeds);
+
+#endif //CMPRSS_VERIFY_H
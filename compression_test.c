@@ -8,7 +8,9 @@
  */
 #include <string.h>
 
-#include ".\compression_test.h"
+#include "compression_test.h"
+#include "cmprss_kernel_impl.h"
+#include "cmprss_predict.h"
 
 cmprss_token_t getMatchLen(buffer_element_t *data_ptr, array_size_t i, array_size_t data_size)
 {
@@ -70,53 +72,29 @@ cmprss_token_t getMatchLen(buffer_element_t *data_ptr, array_size_t i, array_siz
  */
 int estimate_array_size(buffer_element_t *data_ptr, array_size_t data_size)
 {
-  array_size_t i = 0;
-  cmprss_token_t token1;
-  token1.before = NIBBLE_MAX;
-  token1.after = NIBBLE_MAX;
-  array_size_t itterationCount = data_size*2;
-  array_size_t cmprss_size_est = 0;
-
-  while ((i < data_size) && (data_ptr[i] != ERASED_BYTE))
-  {
-    //prefent infinite loop
-    itterationCount--;
-    if (itterationCount <=1)
-      break;
-
-    // get 2x consecutive sets of match/non-match sequences and set them as the lengths in the token along with their match bits
-    token1.before = getMatchLen(data_ptr, i, data_size).after;
-    token1.after = getMatchLen(data_ptr, i + (token1.before & NIBBLE_VALUE_MASK), data_size).after;
-
-    if ((token1.before & NIBBLE_NON_MATCH_BIT) != 0)
-    {
-      cmprss_size_est = cmprss_size_est + (token1.before & NIBBLE_VALUE_MASK) + 1;
-      
-    }
-    else
-    {
-      cmprss_size_est = cmprss_size_est + 1;
-    }
-    i = i + (token1.before & NIBBLE_VALUE_MASK) + 1;
-
-    if ((token1.after & NIBBLE_NON_MATCH_BIT) != 0)
-    {
-      cmprss_size_est = cmprss_size_est + (token1.after & NIBBLE_VALUE_MASK) + 1;
-    }
-    else
-    {
-      cmprss_size_est = cmprss_size_est + 1;
-    }
-    i = i + (token1.after & NIBBLE_VALUE_MASK) + 1;
+  // scalar reference, byte_compress goes through whichever estimate kernel cmprss_dispatch_init bound
+  return estimate_array_size_impl(data_ptr, data_size, getMatchLen);
+}
 
-    //for the token
-    cmprss_size_est = cmprss_size_est + 1;
-  }
+/**
+ * @brief decides whether byte_compress should leave the buffer stored, before any byte is moved
+ *
+ * @param data_ptr
+ * @param data_size
+ * @return uint8_t 1 if compressing would not shrink the buffer
+ */
+uint8_t byte_compress_would_expand(buffer_element_t *data_ptr, array_size_t data_size)
+{
+  // constant time sample first, high entropy buffers go out stored without paying for the full estimate pass
+  if (cmprss_predict_enabled && cmprss_predict_hopeless(data_ptr, data_size))
+    return 1;
 
-  return cmprss_size_est;
+  return cmprss_kernels.estimate_size(data_ptr, data_size) >= data_size;
 }
 
+#if DEBUG_OUTPUT == 1
 #define DEBUG 1
+#endif
 /**
  * @brief compresses a byte array of data using a custom algorithm
  *
@@ -139,11 +117,14 @@ int byte_compress(buffer_element_t *data_ptr, array_size_t data_size)
   memset(eofBuffer, ERASED_BYTE, BUFFER_SIZE);
   uint64_t itterationCount = data_size*2;
 
-  if (estimate_array_size(data_ptr, data_size) >= data_size)
+  PROF_PHASE(PROF_ESTIMATE);
+  if (byte_compress_would_expand(data_ptr, data_size))
   {
     //likely uncompressible via this method, abort
+    PROF_STOP();
     return data_size;
   }
+  PROF_PHASE(PROF_TOKENIZE);
 
   while ((i < data_size) && (data_ptr[i] != ERASED_BYTE))
   {
@@ -153,8 +134,8 @@ int byte_compress(buffer_element_t *data_ptr, array_size_t data_size)
       break;
 
     // get 2x consecutive sets of match/non-match sequences and set them as the lengths in the token along with their match bits
-    token1.before = getMatchLen(data_ptr, i, data_size).after;
-    token1.after = getMatchLen(data_ptr, i + (token1.before & NIBBLE_VALUE_MASK), data_size).after;
+    token1.before = cmprss_kernels.match_len(data_ptr, i, data_size).after;
+    token1.after = cmprss_kernels.match_len(data_ptr, i + (token1.before & NIBBLE_VALUE_MASK), data_size).after;
 
     if ((token1.before == 0) && (token1.after == 0))
       break;
@@ -169,17 +150,17 @@ int byte_compress(buffer_element_t *data_ptr, array_size_t data_size)
         else if (eofWriteIndex+1 < BUFFER_SIZE)
         {
           //eofBuffer[eofWriteIndex--] = data_ptr[data_size-1];
-          memmove(&data_ptr[writeIndex], &data_ptr[i], ((data_size)-(i)));
+          PROF_SCOPE(PROF_SHIFT, PROF_TOKENIZE, memmove(&data_ptr[writeIndex], &data_ptr[i], ((data_size)-(i))));
           
           #ifdef DEBUG
           print_array(data_ptr, data_size);
           #endif
-          memmove(&data_ptr[writeIndex+((data_size)-(i))], &eofBuffer[eofWriteIndex+1], BUFFER_SIZE - (eofWriteIndex+1));
+          PROF_SCOPE(PROF_SHIFT, PROF_TOKENIZE, memmove(&data_ptr[writeIndex+((data_size)-(i))], &eofBuffer[eofWriteIndex+1], BUFFER_SIZE - (eofWriteIndex+1)));
           
           #ifdef DEBUG
           print_array(data_ptr, data_size);
           #endif
-          memset(&data_ptr[writeIndex+(BUFFER_SIZE - (eofWriteIndex+1))+((data_size)-(i))], 0xFF, ((data_size)-(writeIndex+(BUFFER_SIZE - (eofWriteIndex+1))+((data_size)-(i)))));
+          PROF_SCOPE(PROF_SHIFT, PROF_TOKENIZE, memset(&data_ptr[writeIndex+(BUFFER_SIZE - (eofWriteIndex+1))+((data_size)-(i))], 0xFF, ((data_size)-(writeIndex+(BUFFER_SIZE - (eofWriteIndex+1))+((data_size)-(i))))));
           eofWriteIndex = BUFFER_SIZE;
           i = writeIndex; 
           #ifdef DEBUG
@@ -223,7 +204,7 @@ int byte_compress(buffer_element_t *data_ptr, array_size_t data_size)
       else
       {
         //we have non-matching characters which need to be continued
-        memmove(&data_ptr[writeIndex], &data_ptr[i], (token1.before & NIBBLE_VALUE_MASK));
+        PROF_SCOPE(PROF_SHIFT, PROF_TOKENIZE, memmove(&data_ptr[writeIndex], &data_ptr[i], (token1.before & NIBBLE_VALUE_MASK)));
         writeIndex = writeIndex + (token1.before & NIBBLE_VALUE_MASK);
         i = i + (token1.before & NIBBLE_VALUE_MASK);
         buffer = ERASED_BYTE;
@@ -266,7 +247,7 @@ int byte_compress(buffer_element_t *data_ptr, array_size_t data_size)
         data_ptr[writeIndex++] = 0x10 + token1.before;
         
       }
-      memmove(&data_ptr[writeIndex], &data_ptr[i], (token1.before & NIBBLE_VALUE_MASK));
+      PROF_SCOPE(PROF_SHIFT, PROF_TOKENIZE, memmove(&data_ptr[writeIndex], &data_ptr[i], (token1.before & NIBBLE_VALUE_MASK)));
       writeIndex = writeIndex + (token1.before & NIBBLE_VALUE_MASK);
       #ifdef DEBUG
       print_array(data_ptr, data_size);
@@ -313,7 +294,7 @@ int byte_compress(buffer_element_t *data_ptr, array_size_t data_size)
       {
         if ((writeIndex + (token1.after & NIBBLE_VALUE_MASK)) < i)
         {
-          memmove(&data_ptr[writeIndex+1], &data_ptr[writeIndex], (token1.after & NIBBLE_VALUE_MASK));
+          PROF_SCOPE(PROF_SHIFT, PROF_TOKENIZE, memmove(&data_ptr[writeIndex+1], &data_ptr[writeIndex], (token1.after & NIBBLE_VALUE_MASK)));
           data_ptr[writeIndex] = buffer;
           #ifdef DEBUG
           print_array(data_ptr, data_size);
@@ -323,7 +304,7 @@ int byte_compress(buffer_element_t *data_ptr, array_size_t data_size)
         {
           //problem case where we've not got enough space to insert the token
           eofBuffer[eofWriteIndex--] = data_ptr[data_size-1];
-          memmove(&data_ptr[writeIndex+1], &data_ptr[writeIndex], ((data_size-1)-(writeIndex)));
+          PROF_SCOPE(PROF_SHIFT, PROF_TOKENIZE, memmove(&data_ptr[writeIndex+1], &data_ptr[writeIndex], ((data_size-1)-(writeIndex))));
           data_ptr[writeIndex] = buffer;
           #ifdef DEBUG
           print_array(data_ptr, data_size);
@@ -332,7 +313,7 @@ int byte_compress(buffer_element_t *data_ptr, array_size_t data_size)
         }
       }
 
-      memmove(&data_ptr[writeIndex], &data_ptr[i], (token1.after & NIBBLE_VALUE_MASK));
+      PROF_SCOPE(PROF_SHIFT, PROF_TOKENIZE, memmove(&data_ptr[writeIndex], &data_ptr[i], (token1.after & NIBBLE_VALUE_MASK)));
       writeIndex = writeIndex + (token1.after & NIBBLE_VALUE_MASK);
     }
     else
@@ -361,5 +342,6 @@ int byte_compress(buffer_element_t *data_ptr, array_size_t data_size)
 
   size_after_compression = writeIndex;
 
+  PROF_STOP();
   return size_after_compression;
 }
@@ -7,6 +7,43 @@
 
 #define MARKDOWN_OUTPUT 1
 
+// set to 1 (or build with -DRUN_BENCHMARKS=1) to run the benchmarks after the regression tests
+#ifndef RUN_BENCHMARKS
+#define RUN_BENCHMARKS 0
+#endif
+
+// set to 1 (or build with -DRUN_VERIFY=1) to run the large scale round trip verification after the regression tests
+#ifndef RUN_VERIFY
+#define RUN_VERIFY 0
+#endif
+
+// set to 1 (or build with -DPROFILE_PHASES=1) to count cycles, instructions, branch and L1D misses per codec phase,
+// the benchmark build then prints them. Off, the PROF_PHASE marks in the codec compile to nothing
+#ifndef PROFILE_PHASES
+#define PROFILE_PHASES 0
+#endif
+
+// set to 1 (or build with -DCMPRSS_SELF_TEST=1) to check every kernel set and token format after the regression
+// tests. On by default in the benchmark and verification builds, off in the debug build, where the step-by-step
+// prints of the kernels it calls would bury the test output
+#ifndef CMPRSS_SELF_TEST
+#if (RUN_BENCHMARKS == 1) || (RUN_VERIFY == 1)
+#define CMPRSS_SELF_TEST 1
+#else
+#define CMPRSS_SELF_TEST 0
+#endif
+#endif
+
+// step-by-step array prints inside the codec, these would swamp any timing so they are off for benchmark and
+// verification builds
+#ifndef DEBUG_OUTPUT
+#if (RUN_BENCHMARKS == 1) || (RUN_VERIFY == 1)
+#define DEBUG_OUTPUT 0
+#else
+#define DEBUG_OUTPUT 1
+#endif
+#endif
+
 #define MAX_INPUT_SIZE 256
 #define BUFFER_SIZE 64
 #define TOKEN_INIT 0
@@ -32,13 +69,15 @@ typedef union
 
 
 void print_array(uint8_t *data_ptr, array_size_t data_size);
-//cmprss_token_t getMatchLen(buffer_element_t *data_ptr, array_size_t i, array_size_t data_size);
-//int estimate_array_size(buffer_element_t *data_ptr, array_size_t data_size);
+cmprss_token_t getMatchLen(buffer_element_t *data_ptr, array_size_t i, array_size_t data_size);
+int estimate_array_size(buffer_element_t *data_ptr, array_size_t data_size);
+uint8_t byte_compress_would_expand(buffer_element_t *data_ptr, array_size_t data_size);
 int byte_compress(buffer_element_t *data_ptr, array_size_t data_size);
 int run_verbose_compression_test(buffer_element_t *data_ptr, array_size_t data_size);
 uint8_t ArraysAreEqual(buffer_element_t *data_ptr1, buffer_element_t *data_ptr2, array_size_t data_size);
 
 int byte_decompress(buffer_element_t *uncmprss_data_ptr, array_size_t uncmprss_data_size, buffer_element_t *cmprss_data_ptr, array_size_t cmpress_data_size);
+int byte_decompress_scalar(buffer_element_t *uncmprss_data_ptr, array_size_t uncmprss_data_size, buffer_element_t *cmprss_data_ptr, array_size_t cmpress_data_size);
 
 
 
@@ -0,0 +1,197 @@
+/**
+ * @file dict_train.c
+ * @brief command line dictionary trainer, builds the priming dictionary for the dictionary formats
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * Usage: dict_train [-s size] [-l] out.dict sample...
+ * Every sample file is one message, or with -l every line of every file is one message (the line break is not
+ * part of it). The dictionary is written as raw bytes, load it on both sides with cmprss_dict_load. The id it
+ * prints is cmprss_dict_t.id, compare it on both ends to be sure they loaded the same file.
+ * Built on its own with the "C/C++: gcc.exe build dictionary trainer" task, it only needs cmprss_dict.c.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cmprss_dict.h"
+
+#define TRAIN_MAX_SAMPLES (1u << 20)
+#define TRAIN_READ_CHUNK 4096
+
+static buffer_element_t *samples_ptr = NULL;
+static array_size_t samples_bytes = 0, samples_cap = 0;
+static array_size_t sample_sizes[TRAIN_MAX_SAMPLES];
+static uint32_t num_samples = 0;
+static buffer_element_t dict_data[DICT_MAX_SIZE];
+static cmprss_dict_t dict;
+
+/**
+ * @brief appends bytes to the sample buffer
+ *
+ * @param data_ptr
+ * @param data_size
+ * @return uint8_t 0 if out of memory
+ */
+static uint8_t append_bytes(const buffer_element_t *data_ptr, array_size_t data_size)
+{
+  buffer_element_t *grown = NULL;
+
+  if ((samples_bytes + data_size) > samples_cap)
+  {
+    samples_cap = (samples_cap * 2) + data_size + TRAIN_READ_CHUNK;
+    grown = realloc(samples_ptr, samples_cap);
+    if (grown == NULL)
+      return 0;
+    samples_ptr = grown;
+  }
+  memcpy(&samples_ptr[samples_bytes], data_ptr, data_size);
+  samples_bytes += data_size;
+  return 1;
+}
+
+/**
+ * @brief releases the sample buffer, safe to call more than once
+ *
+ */
+static void free_samples(void)
+{
+  free(samples_ptr);
+  samples_ptr = NULL;
+  samples_bytes = 0;
+  samples_cap = 0;
+}
+
+/**
+ * @brief reads one sample file, whole or split into lines
+ *
+ * @param path
+ * @param by_line
+ * @return uint8_t 0 on a read error or too many samples, the sample buffer is freed then
+ */
+static uint8_t read_samples(const char *path, uint8_t by_line)
+{
+  buffer_element_t chunk[TRAIN_READ_CHUNK];
+  array_size_t sample_start = samples_bytes;
+  size_t got = 0;
+  FILE *file = fopen(path, "rb");
+
+  if (file == NULL)
+  {
+    fprintf(stderr, "can not open %s\n", path);
+    free_samples();
+    return 0;
+  }
+
+  while ((got = fread(chunk, 1, sizeof(chunk), file)) > 0)
+  {
+    if (!append_bytes(chunk, got))
+    {
+      fclose(file);
+      fprintf(stderr, "out of memory reading %s\n", path);
+      free_samples();
+      return 0;
+    }
+  }
+  fclose(file);
+
+  // split in place, the line breaks are squeezed out
+  if (by_line)
+  {
+    array_size_t read_index = sample_start, write_index = sample_start, line_start = sample_start;
+    array_size_t end = samples_bytes;
+
+    for (; read_index <= end; read_index++)
+    {
+      if ((read_index == end) || (samples_ptr[read_index] == '\n') || (samples_ptr[read_index] == '\r'))
+      {
+        if (write_index > line_start)
+        {
+          if (num_samples >= TRAIN_MAX_SAMPLES)
+          {
+            fprintf(stderr, "more than %u samples, stopped at %s\n", TRAIN_MAX_SAMPLES, path);
+            free_samples();
+            return 0;
+          }
+          sample_sizes[num_samples++] = write_index - line_start;
+        }
+        line_start = write_index;
+      }
+      else
+      {
+        samples_ptr[write_index++] = samples_ptr[read_index];
+      }
+    }
+    samples_bytes = write_index;
+  }
+  else if (samples_bytes > sample_start)
+  {
+    if (num_samples >= TRAIN_MAX_SAMPLES)
+    {
+      fprintf(stderr, "more than %u samples, stopped at %s\n", TRAIN_MAX_SAMPLES, path);
+      free_samples();
+      return 0;
+    }
+    sample_sizes[num_samples++] = samples_bytes - sample_start;
+  }
+
+  return 1;
+}
+
+int main(int argc, char **argv)
+{
+  array_size_t dict_cap = DICT_TRAIN_SIZE, dict_size = 0;
+  uint8_t by_line = 0;
+  const char *out_path = NULL;
+  FILE *out = NULL;
+  int arg = 1;
+
+  for (; (arg < argc) && (argv[arg][0] == '-'); arg++)
+  {
+    if ((strcmp(argv[arg], "-s") == 0) && ((arg + 1) < argc))
+      dict_cap = (array_size_t)strtoul(argv[++arg], NULL, 0);
+    else if (strcmp(argv[arg], "-l") == 0)
+      by_line = 1;
+    else
+      break;
+  }
+  if (((argc - arg) < 2) || (dict_cap == 0) || (dict_cap > DICT_MAX_SIZE))
+  {
+    fprintf(stderr, "usage: %s [-s size] [-l] out.dict sample...\n", argv[0]);
+    fprintf(stderr, "  -s size  dictionary size in bytes, default %u, at most %u\n", DICT_TRAIN_SIZE, DICT_MAX_SIZE);
+    fprintf(stderr, "  -l       every line is a sample, otherwise every file is one\n");
+    return 1;
+  }
+
+  out_path = argv[arg++];
+  for (; arg < argc; arg++)
+  {
+    if (!read_samples(argv[arg], by_line))
+      return 1;
+  }
+
+  dict_size = cmprss_dict_train(dict_data, dict_cap, samples_ptr, sample_sizes, num_samples);
+  if (dict_size == 0)
+  {
+    fprintf(stderr, "the %u samples share nothing to train on\n", num_samples);
+    free_samples();
+    return 1;
+  }
+  cmprss_dict_load(&dict, dict_data, dict_size);
+
+  out = fopen(out_path, "wb");
+  if ((out == NULL) || (fwrite(dict_data, 1, dict_size, out) != dict_size))
+  {
+    fprintf(stderr, "can not write %s\n", out_path);
+    if (out != NULL)
+      fclose(out);
+    free_samples();
+    return 1;
+  }
+  fclose(out);
+
+  printf("%s: %llu bytes from %u samples (%llu bytes), id 0x%08X\n", out_path, (unsigned long long)dict_size, num_samples,
+         (unsigned long long)samples_bytes, dict.id);
+  free_samples();
+  return 0;
+}
@@ -5,6 +5,14 @@
 
 #include "compression_test.h"
 #include "test_arrays.h"
+#include "cmprss_dispatch.h"
+#include "cmprss_formats.h"
+#if RUN_BENCHMARKS == 1
+#include "benchmark.h"
+#endif
+#if RUN_VERIFY == 1
+#include "cmprss_verify.h"
+#endif
 
 /**
  * @brief prints the input array to the console in a formatted fashion
@@ -227,6 +235,8 @@ uint8_t input_data_ptr[INPUT_SIZE] =
  */
 void main(void)
 {
+  cmprss_dispatch_init();
+
   //debug
   regression_test(test_arrays[2], array_sizes[2]);
   //end debug
@@ -239,7 +249,31 @@ void main(void)
         return;
   }
 
+  #if CMPRSS_SELF_TEST == 1
+  if (!cmprss_dispatch_self_test())
+    return;
+
+  if (!cmprss_format_self_test())
+    return;
+  #endif
+
   printf("All tests Passed\n");
 
+  #if RUN_VERIFY == 1
+  if (!cmprss_verify_run(test_arrays, array_sizes, NUM_TESTS))
+    return;
+  #endif
+
+  #if RUN_BENCHMARKS == 1
+  run_pipeline_benchmark();
+  run_kernel_benchmark();
+  run_predictor_benchmark();
+  run_format_benchmark();
+  run_dict_benchmark();
+  #if PROFILE_PHASES == 1
+  run_profile_benchmark();
+  #endif
+  #endif
+
   return;
 }
\ No newline at end of file